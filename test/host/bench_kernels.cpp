@@ -0,0 +1,52 @@
+/*
+  Throughput of the render kernels on the host.
+
+  Every mode of LED_MODES renders BENCH_FRAMES frames at its own frame
+  rate, once the kernel alone and once the whole frame of handleLeds
+  (composite, power estimate, overlays and show). The numbers compare
+  kernels and changes on the host, they are no AVR cycle counts.
+*/
+
+#include <chrono>
+
+#include "host.h"
+
+#define BENCH_FRAMES 20000
+
+typedef std::chrono::steady_clock BenchClock;
+
+double nanosPerFrame(uint8_t mode, bool isWholeFrame)
+{
+  setLEDModeState(mode);
+  uint32_t period = 1000000UL / modeFps(mode);
+  BenchClock::time_point start = BenchClock::now();
+  for (uint32_t f = 0; f < BENCH_FRAMES; f++)
+  {
+    host.micros += period;
+    if (isWholeFrame)
+    {
+      handleLeds();
+    }
+    else
+    {
+      animationClock.tick();
+      modeRender(mode)();
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = BenchClock::now() - start;
+  return elapsed.count() / BENCH_FRAMES;
+}
+
+int main()
+{
+  setup();
+  autoCycleHue = false;
+  printf("%-20s %4s %12s %12s\n", "mode", "fps", "kernel ns", "frame ns");
+  for (uint8_t mode = 0; mode < LED_MODE_COUNT; mode++)
+  {
+    double kernel = nanosPerFrame(mode, false);
+    double frame = nanosPerFrame(mode, true);
+    printf("%-20s %4d %12.0f %12.0f\n", (const char *)modeText(mode) + 2, modeFps(mode), kernel, frame);
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef HOST_TEST_HEADER
+#define HOST_TEST_HEADER
+
+/*
+  Host build of the sketch for tests and benchmarks.
+
+  Every test program includes the whole sketch once, like the Arduino
+  build, against the stand-ins in stubs/. Globals of the sketch are
+  reachable from the test, time only moves with host.micros.
+*/
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "../../wordclock.ino"
+
+static int hostFailures = 0;
+
+#define CHECK(condition)                                                             \
+  do                                                                                 \
+  {                                                                                  \
+    if (!(condition))                                                                \
+    {                                                                                \
+      if (hostFailures++ < 20)                                                       \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+    }                                                                                \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                          \
+  do                                                                                        \
+  {                                                                                         \
+    long a_ = (long)(actual), e_ = (long)(expected);                                        \
+    if (a_ != e_)                                                                           \
+    {                                                                                       \
+      if (hostFailures++ < 20)                                                              \
+        fprintf(stderr, "%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #actual, a_, e_); \
+    }                                                                                       \
+  } while (0)
+
+/**
+ * Report the result, the return value of main().
+ */
+inline int hostResult(const char *name)
+{
+  printf("%s: %s\n", name, hostFailures ? "FAILED" : "ok");
+  return hostFailures ? 1 : 0;
+}
+
+/**
+ * Whether a pixel is part of a mask.
+ */
+inline bool hostMaskBit(const uint8_t *mask, uint16_t led)
+{
+  return mask[led >> 3] & (1 << (led & 7));
+}
+
+/**
+ * Set the time of both the fake RTC and the sketch.
+ */
+inline void hostSetTime(uint8_t hours, uint8_t minutes, uint8_t wday = 1)
+{
+  hostRTC.time.Hour = t.Hour = hours;
+  hostRTC.time.Minute = t.Minute = minutes;
+  hostRTC.time.Second = t.Second = 0;
+  hostRTC.time.Wday = t.Wday = wday;
+}
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+  Host stand-in for the Arduino core.
+
+  Time only moves when a test advances host.micros, registers are plain
+  variables and PROGMEM is ordinary memory. Only the parts the sketch
+  uses are provided.
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+/* Flash */
+#define PROGMEM
+#define F(s) ((const __FlashStringHelper *)(s))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define memcpy_P memcpy
+class __FlashStringHelper;
+
+/* Pins and interrupts */
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define DEC 10
+#define HEX 16
+#define ISR(vector) void vector()
+#define digitalPinToInterrupt(pin) ((pin) == 2 ? 0 : ((pin) == 3 ? 1 : -1))
+#define noInterrupts()
+#define interrupts()
+
+/**
+ * State of the fake board, set and inspected by the tests.
+ */
+struct HostBoard
+{
+  uint32_t micros;      // advanced by the tests and by delay()
+  uint32_t idles;       // Energy::Idle calls
+  uint32_t idleMicros;  // length of an idle sleep
+  uint32_t powerDowns;  // Energy::PowerDown calls
+  uint32_t shows;       // FastLED.show calls
+  uint8_t brightness;   // last FastLED.setBrightness
+  const char *serialIn; // bytes returned by Serial.read, NULL when empty
+};
+extern HostBoard host;
+
+/* ATmega328P registers used by the timer and the USART output */
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, UCSR0B, UCSR0C, DDRD, PORTD;
+extern volatile uint16_t TCNT1, OCR1A, UBRR0;
+#define TCNT0 ((uint8_t)(host.micros / 4)) // Timer0 with prescaler 64 at 16 MHz
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define OCIE1A 1
+#define TXEN0 3
+#define UDRE0 5
+#define TXC0 6
+#define UMSEL00 6
+#define UMSEL01 7
+#define DDD1 1
+#define DDD4 4
+#define PORTD1 1
+
+/**
+ * USART0 of the fake board. Symbols written to UDR0 are recorded, the
+ * data register is always free. The shift register runs empty (TXC0)
+ * after three status reads without a write, or right after symbol
+ * gapAfter, like a refill an ISR delayed by gapMicros.
+ */
+#define HOST_USART_SYMBOLS 2048
+
+struct HostUsart
+{
+  uint8_t symbols[HOST_USART_SYMBOLS];
+  uint16_t count;     // symbols written since the test cleared it
+  uint16_t gapAfter;  // 0: no gap
+  uint16_t gapMicros; // board time passing after symbol gapAfter
+  uint8_t polls;      // status reads since the last write
+  bool isEmpty;       // TXC0
+};
+extern HostUsart hostUsart;
+
+struct HostStatusRegister
+{
+  operator uint8_t()
+  {
+    if (++hostUsart.polls >= 3)
+      hostUsart.isEmpty = true;
+    return (1 << 5) | (hostUsart.isEmpty ? (1 << 6) : 0); // UDRE0, TXC0
+  }
+  HostStatusRegister &operator|=(uint8_t flags)
+  {
+    if (flags & (1 << 6))
+      hostUsart.isEmpty = false; // cleared by writing one
+    return *this;
+  }
+};
+
+struct HostDataRegister
+{
+  HostDataRegister &operator=(uint8_t symbol)
+  {
+    if (hostUsart.count < HOST_USART_SYMBOLS)
+      hostUsart.symbols[hostUsart.count] = symbol;
+    hostUsart.count++;
+    hostUsart.polls = 0;
+    hostUsart.isEmpty = (hostUsart.count == hostUsart.gapAfter);
+    if (hostUsart.isEmpty)
+      host.micros += hostUsart.gapMicros;
+    return *this;
+  }
+};
+
+extern HostStatusRegister UCSR0A;
+extern HostDataRegister UDR0;
+
+inline unsigned long micros() { return host.micros; }
+inline unsigned long millis() { return host.micros / 1000; }
+inline void delay(unsigned long ms) { host.micros += ms * 1000; }
+inline void delayMicroseconds(unsigned int us) { host.micros += us; }
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void attachInterrupt(int8_t, void (*)(), int) {}
+
+template <typename T> T min(T a, T b) { return (a < b) ? a : b; }
+template <typename T> T max(T a, T b) { return (a > b) ? a : b; }
+
+/* Serial */
+class Print
+{
+public:
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t n) { return n; }
+  template <typename T> size_t print(T) { return 0; }
+  template <typename T> size_t print(T, int) { return 0; }
+  size_t println() { return 0; }
+  template <typename T> size_t println(T) { return 0; }
+  template <typename T> size_t println(T, int) { return 0; }
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long) {}
+  operator bool() { return true; }
+  int available() { return (host.serialIn != NULL) && (*host.serialIn != 0); }
+  int read() { return available() ? *host.serialIn++ : -1; }
+  int availableForWrite() { return 63; }
+};
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef HOST_DS3232RTC_H
+#define HOST_DS3232RTC_H
+
+/*
+  Host stand-in for the DS3232RTC library (2.x). The chip's time and
+  alarm registers are kept in hostRTC.
+*/
+
+#include "Arduino.h"
+
+typedef struct
+{
+  uint8_t Second;
+  uint8_t Minute;
+  uint8_t Hour;
+  uint8_t Wday; // day of week, sunday is day 1
+  uint8_t Day;
+  uint8_t Month;
+  uint8_t Year; // offset from 1970
+} tmElements_t;
+
+/**
+ * Registers of the fake chip.
+ */
+struct HostRTC
+{
+  tmElements_t time;     // returned by read()
+  uint8_t readError;     // returned by read(), time is not copied when set
+  uint32_t reads;        // read() calls
+  uint32_t readMicros;   // time a read() takes
+  uint8_t alarmType;     // last setAlarm() of alarm 2
+  uint8_t alarmMinutes;
+  uint8_t alarmHours;
+  uint8_t alarmDayDate;
+  bool isAlarm2Enabled;  // alarmInterrupt(ALARM_2, ...)
+  uint8_t squareWave;    // last squareWave()
+  void (*onSquareWave)(); // called by squareWave() before it takes effect, e.g. an edge during the write
+};
+extern HostRTC hostRTC;
+
+class DS3232RTC
+{
+public:
+  enum ALARM_TYPES_t
+  {
+    ALM1_EVERY_SECOND = 0x0F,
+    ALM1_MATCH_SECONDS = 0x0E,
+    ALM1_MATCH_MINUTES = 0x0C,
+    ALM1_MATCH_HOURS = 0x08,
+    ALM1_MATCH_DATE = 0x00,
+    ALM1_MATCH_DAY = 0x10,
+    ALM2_EVERY_MINUTE = 0x8E,
+    ALM2_MATCH_MINUTES = 0x8C,
+    ALM2_MATCH_HOURS = 0x88,
+    ALM2_MATCH_DATE = 0x80,
+    ALM2_MATCH_DAY = 0x90
+  };
+  enum ALARM_NBR_t
+  {
+    ALARM_1 = 1,
+    ALARM_2 = 2
+  };
+  enum SQWAVE_FREQS_t
+  {
+    SQWAVE_1_HZ,
+    SQWAVE_1024_HZ,
+    SQWAVE_4096_HZ,
+    SQWAVE_8192_HZ,
+    SQWAVE_NONE
+  };
+
+  void begin() {}
+
+  uint8_t read(tmElements_t &tm)
+  {
+    hostRTC.reads++;
+    host.micros += hostRTC.readMicros;
+    if (hostRTC.readError == 0)
+      tm = hostRTC.time;
+    return hostRTC.readError;
+  }
+
+  uint8_t write(tmElements_t &tm)
+  {
+    hostRTC.time = tm;
+    return 0;
+  }
+
+  void setAlarm(ALARM_TYPES_t type, uint8_t seconds, uint8_t minutes, uint8_t hours, uint8_t daydate)
+  {
+    if (!(type & 0x80))
+      return; // alarm 1 is not used by the sketch
+    hostRTC.alarmType = type;
+    hostRTC.alarmMinutes = minutes;
+    hostRTC.alarmHours = hours;
+    hostRTC.alarmDayDate = daydate;
+  }
+
+  bool alarm(ALARM_NBR_t) { return false; }
+
+  void alarmInterrupt(ALARM_NBR_t alarmNumber, bool enable)
+  {
+    if (alarmNumber == ALARM_2)
+      hostRTC.isAlarm2Enabled = enable;
+  }
+
+  void squareWave(SQWAVE_FREQS_t freq)
+  {
+    if (hostRTC.onSquareWave != NULL)
+      hostRTC.onSquareWave();
+    hostRTC.squareWave = freq;
+  }
+};
+
+#endif
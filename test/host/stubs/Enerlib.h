@@ -0,0 +1,22 @@
+#ifndef HOST_ENERLIB_H
+#define HOST_ENERLIB_H
+
+/*
+  Host stand-in for Enerlib, sleeping counts the calls. Idle lasts
+  host.idleMicros, until the next interrupt of the fake board.
+*/
+
+#include "Arduino.h"
+
+class Energy
+{
+public:
+  void Idle()
+  {
+    host.idles++;
+    host.micros += host.idleMicros;
+  }
+  void PowerDown() { host.powerDowns++; }
+};
+
+#endif
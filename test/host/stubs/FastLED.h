@@ -0,0 +1,292 @@
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+/*
+  Host stand-in for FastLED.
+
+  The math helpers follow FastLED's lib8tion, so kernels do comparable
+  work on the host. Colors are not converted: a CHSV becomes
+  CRGB(hue, saturation, value), black for value 0, which lets tests
+  read hue and level of a pixel back. FastLED.show() counts the calls
+  and lets a controller added with addLeds(&controller, ...) shift the
+  pixels out.
+*/
+
+#include "Arduino.h"
+
+#define FASTLED_USING_NAMESPACE
+
+typedef uint8_t fract8;
+
+enum EOrder
+{
+  RGB = 0012,
+  GRB = 0102
+};
+
+enum ESM
+{
+  WS2812B
+};
+
+#define TypicalLEDStrip 0xFFB0F0
+
+struct CHSV
+{
+  uint8_t h, s, v;
+  CHSV() {}
+  CHSV(uint8_t hue, uint8_t sat, uint8_t val) : h(hue), s(sat), v(val) {}
+};
+
+/* lib8tion */
+inline uint8_t scale8(uint8_t i, fract8 scale)
+{
+  return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+inline uint8_t scale8_video(uint8_t i, fract8 scale)
+{
+  return (((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint16_t scale16(uint16_t i, uint16_t scale)
+{
+  return ((uint32_t)i * (1 + (uint32_t)scale)) >> 16;
+}
+
+inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+  unsigned sum = i + j;
+  return (sum > 255) ? 255 : sum;
+}
+
+inline int16_t sin16(uint16_t theta)
+{
+  return (int16_t)(sin(theta * (2 * M_PI / 65536.0)) * 32767);
+}
+
+inline uint8_t sin8(uint8_t theta)
+{
+  return (uint8_t)(128 + (sin16((uint16_t)theta << 8) >> 8));
+}
+
+inline uint16_t beat88(uint16_t bpm88, uint32_t timebase = 0)
+{
+  return ((millis() - timebase) * bpm88 * 280) >> 16;
+}
+
+inline uint16_t beat16(uint16_t bpm, uint32_t timebase = 0)
+{
+  return beat88((bpm < 256) ? (bpm << 8) : bpm, timebase);
+}
+
+inline uint8_t beat8(uint16_t bpm, uint32_t timebase = 0)
+{
+  return beat16(bpm, timebase) >> 8;
+}
+
+inline uint8_t beatsin8(uint16_t bpm, uint8_t lowest = 0, uint8_t highest = 255, uint32_t timebase = 0, uint8_t phase = 0)
+{
+  uint8_t beatsin = sin8(beat8(bpm, timebase) + phase);
+  return lowest + scale8(beatsin, highest - lowest);
+}
+
+inline uint16_t beatsin16(uint16_t bpm, uint16_t lowest = 0, uint16_t highest = 65535, uint32_t timebase = 0, uint16_t phase = 0)
+{
+  uint16_t beatsin = sin16(beat16(bpm, timebase) + phase) + 32768;
+  return lowest + scale16(beatsin, highest - lowest);
+}
+
+extern uint16_t rand16seed;
+
+inline uint16_t random16()
+{
+  rand16seed = (rand16seed * 2053) + 13849;
+  return rand16seed;
+}
+
+inline uint16_t random16(uint16_t lim)
+{
+  return ((uint32_t)random16() * lim) >> 16;
+}
+
+inline uint8_t random8()
+{
+  random16();
+  return (uint8_t)((rand16seed & 0xFF) + (rand16seed >> 8));
+}
+
+inline uint8_t random8(uint8_t lim)
+{
+  return ((uint16_t)random8() * lim) >> 8;
+}
+
+inline uint8_t random8(uint8_t min, uint8_t lim)
+{
+  return min + random8(lim - min);
+}
+
+struct CRGB
+{
+  uint8_t r, g, b;
+
+  enum HTMLColorCode
+  {
+    Black = 0x000000,
+    White = 0xFFFFFF
+  };
+
+  CRGB() = default;
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode) : r(colorcode >> 16), g(colorcode >> 8), b(colorcode) {}
+  CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+  CRGB(const CHSV &hsv) : r(hsv.v ? hsv.h : 0), g(hsv.v ? hsv.s : 0), b(hsv.v) {}
+
+  uint8_t &operator[](uint8_t x) { return (&r)[x]; }
+  const uint8_t &operator[](uint8_t x) const { return (&r)[x]; }
+
+  CRGB &operator+=(const CRGB &rhs)
+  {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB &operator|=(const CRGB &rhs)
+  {
+    r = max(r, rhs.r);
+    g = max(g, rhs.g);
+    b = max(b, rhs.b);
+    return *this;
+  }
+
+  CRGB &nscale8(uint8_t scale)
+  {
+    r = scale8(r, scale);
+    g = scale8(g, scale);
+    b = scale8(b, scale);
+    return *this;
+  }
+
+  bool operator==(const CRGB &rhs) const { return (r == rhs.r) && (g == rhs.g) && (b == rhs.b); }
+  bool operator!=(const CRGB &rhs) const { return !(*this == rhs); }
+  explicit operator bool() const { return r || g || b; }
+};
+
+typedef uint32_t TProgmemRGBPalette16[16];
+extern const TProgmemRGBPalette16 PartyColors_p;
+
+inline void fill_solid(CRGB *leds, int numToFill, const CRGB &color)
+{
+  for (int i = 0; i < numToFill; i++)
+    leds[i] = color;
+}
+
+inline void fill_rainbow(CRGB *leds, int numToFill, uint8_t initialhue, uint8_t deltahue = 5)
+{
+  for (int i = 0; i < numToFill; i++)
+    leds[i] = CHSV(initialhue + (i * deltahue), 240, 255);
+}
+
+inline void nscale8(CRGB *leds, uint16_t numLeds, uint8_t scale)
+{
+  for (uint16_t i = 0; i < numLeds; i++)
+    leds[i].nscale8(scale);
+}
+
+inline void fadeToBlackBy(CRGB *leds, uint16_t numLeds, uint8_t fadeBy)
+{
+  nscale8(leds, numLeds, 255 - fadeBy);
+}
+
+/* Controllers */
+/**
+ * Pixels of one show() in the strip's color order, scaled by brightness.
+ */
+template <EOrder RGB_ORDER>
+class PixelController
+{
+public:
+  PixelController(const CRGB *leds, int count, uint8_t brightness) : data(leds), left(count), scale(brightness) {}
+
+  bool has(int n) { return left >= n; }
+  void advanceData() { data++, left--; }
+  void preStepFirstByteDithering() {}
+  void stepDithering() {}
+  uint8_t loadAndScale0() { return channel((RGB_ORDER >> 6) & 3); }
+  uint8_t loadAndScale1() { return channel((RGB_ORDER >> 3) & 3); }
+  uint8_t loadAndScale2() { return channel(RGB_ORDER & 3); }
+
+private:
+  const CRGB *data;
+  int left;
+  uint8_t scale;
+
+  uint8_t channel(uint8_t x) { return scale8((*data)[x], scale); }
+};
+
+class CLEDController
+{
+public:
+  CLEDController() : leds(NULL), count(0) {}
+  virtual ~CLEDController() {}
+  virtual void init() {}
+  virtual void showLeds(uint8_t brightness) {}
+  CLEDController &setCorrection(uint32_t) { return *this; }
+
+  CRGB *leds;
+  int count;
+};
+
+template <EOrder RGB_ORDER>
+class CPixelLEDController : public CLEDController
+{
+public:
+  virtual void showLeds(uint8_t brightness)
+  {
+    PixelController<RGB_ORDER> pixels(leds, count, brightness);
+    showPixels(pixels);
+  }
+
+protected:
+  virtual void showPixels(PixelController<RGB_ORDER> &pixels) = 0;
+};
+
+class CFastLED
+{
+public:
+  CFastLED() : controller(&builtin), brightness(255) {}
+
+  template <ESM CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CLEDController &addLeds(CRGB *leds, int count)
+  {
+    return addLeds(&builtin, leds, count);
+  }
+
+  CLEDController &addLeds(CLEDController *added, CRGB *leds, int count)
+  {
+    controller = added;
+    controller->leds = leds;
+    controller->count = count;
+    controller->init();
+    return *controller;
+  }
+
+  void setBrightness(uint8_t scale) { brightness = host.brightness = scale; }
+  uint8_t getBrightness() { return brightness; }
+
+  void show()
+  {
+    host.shows++;
+    controller->showLeds(brightness);
+  }
+
+private:
+  CLEDController builtin; // FastLED's clockless driver, nothing to shift out on the host
+  CLEDController *controller;
+  uint8_t brightness;
+};
+extern CFastLED FastLED;
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef HOST_IRREMOTE_H
+#define HOST_IRREMOTE_H
+
+/*
+  Host stand-in for IRremote 2.x, decode() returns the signal sent with
+  hostSendIR(). Only the receiver side the sketch uses is provided.
+*/
+
+#include "Arduino.h"
+
+enum decode_type_t
+{
+  UNKNOWN = -1,
+  UNUSED = 0,
+  NEC = 1
+};
+
+class decode_results
+{
+public:
+  decode_type_t decode_type;
+  unsigned long value;
+  int bits;
+};
+
+/**
+ * Signal waiting in the receiver, taken by IRrecv::decode.
+ */
+struct HostIR
+{
+  bool isPending;
+  decode_type_t type;
+  unsigned long value;
+};
+extern HostIR hostIR;
+
+inline void hostSendIR(unsigned long value, decode_type_t type = NEC)
+{
+  hostIR.isPending = true;
+  hostIR.type = type;
+  hostIR.value = value;
+}
+
+class IRrecv
+{
+public:
+  IRrecv(int) {}
+  void enableIRIn() {}
+  void resume() {}
+
+  int decode(decode_results *results)
+  {
+    if (!hostIR.isPending)
+      return 0;
+    hostIR.isPending = false;
+    results->decode_type = hostIR.type;
+    results->value = hostIR.value;
+    results->bits = 32;
+    return 1;
+  }
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+/*
+  Host stand-in for avr/eeprom.h, the EEPROM is kept in hostEeprom.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define HOST_EEPROM_SIZE 1024
+
+extern uint8_t hostEeprom[HOST_EEPROM_SIZE];
+extern uint32_t hostEepromWrites; // bytes written since boot
+extern int32_t hostEepromBudget;  // bytes written before the power fails, -1 never fails
+
+inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+  memcpy(dst, hostEeprom + (uintptr_t)src, n);
+}
+
+inline void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+  if (hostEepromBudget == 0)
+    return; // power is gone, the write is lost
+  if (hostEepromBudget > 0)
+    hostEepromBudget--;
+
+  hostEepromWrites++;
+  hostEeprom[(uintptr_t)address] = value;
+}
+
+inline bool eeprom_is_ready()
+{
+  return true;
+}
+
+#endif
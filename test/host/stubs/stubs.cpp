@@ -0,0 +1,30 @@
+/*
+  State of the host stand-ins, see the headers in this directory.
+*/
+
+#include "Arduino.h"
+#include "DS3232RTC.h"
+#include "FastLED.h"
+#include "IRremote.h"
+#include "avr/eeprom.h"
+
+HostBoard host = {};
+HostRTC hostRTC = {};
+HostIR hostIR = {};
+uint8_t hostEeprom[HOST_EEPROM_SIZE];
+uint32_t hostEepromWrites = 0;
+int32_t hostEepromBudget = -1;
+
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, UCSR0B, UCSR0C, DDRD, PORTD;
+volatile uint16_t TCNT1, OCR1A, UBRR0;
+HostUsart hostUsart = {};
+HostStatusRegister UCSR0A;
+HostDataRegister UDR0;
+
+HardwareSerial Serial;
+CFastLED FastLED;
+uint16_t rand16seed = 1337;
+
+const TProgmemRGBPalette16 PartyColors_p = {
+    0x5500AB, 0x84007C, 0xB5004B, 0xE5001B, 0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+    0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E, 0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9};
@@ -0,0 +1,80 @@
+/*
+  Frame rates of the time display and the matrix animation.
+
+  Normal mode with a cycling color must only show a frame when the time
+  changes, and matrix drops have to fall at the same speed at any frame
+  rate.
+*/
+
+#include "host.h"
+
+/**
+ * Row of a column's drop head, -1 above the face.
+ */
+int headRow(const CRGB *frame, uint8_t col)
+{
+  for (uint8_t row = 0; row < LED_ROWS; row++)
+  {
+    const CRGB &pixel = frame[Geometry<LED_ROWS, LED_COLUMNS>::xy(row, col)];
+    if (pixel && (pixel.g == 128)) // saturation of the head, see matrix()
+      return row;
+  }
+  return -1;
+}
+
+/**
+ * Let a fresh matrix run for the given time, returns its last frame in heads.
+ */
+void runMatrix(uint16_t fps, uint32_t duration, int *heads)
+{
+  Wordclock<LED_ROWS, LED_COLUMNS, WordLayout> clock;
+  rand16seed = 1337;
+  animationClock.tick();
+  for (uint32_t elapsed = 0; elapsed < duration; elapsed += 1000000UL / fps)
+  {
+    host.micros += 1000000UL / fps;
+    animationClock.tick();
+    clock.matrix(leds);
+  }
+  for (uint8_t col = 0; col < LED_COLUMNS; col++)
+    heads[col] = headRow(leds, col);
+}
+
+int main()
+{
+  // ten minutes of normal mode at its 25 fps, the color cycling
+  ledMode = LED_MODE_NORMAL;
+  autoCycleHue = true;
+  FastLED.setBrightness(LED_BRIGHTNESS);
+  hostSetTime(9, 0);
+  updateTime = true;
+  handleLeds();
+  uint8_t startHue = hue;
+  uint32_t shows = host.shows;
+  for (uint32_t frame = 1; frame <= 10UL * 60 * 25; frame++)
+  {
+    host.micros += 40000;
+    if ((frame % (60 * 25)) == 0)
+    {
+      t.Minute++;
+      updateTime = true;
+    }
+    handleLeds();
+  }
+  CHECK(host.shows - shows <= 10 * (LED_CROSSFADE_FRAMES + 1));
+  CHECK_EQ((uint8_t)(hue - startHue), (uint8_t)(10 * LED_AUTO_HUE_STEP));
+
+  // matrix drops after 400 ms at 60 fps and 20 fps, before any drop respawns
+  int fast[LED_COLUMNS], slow[LED_COLUMNS];
+  runMatrix(60, 400000, fast);
+  runMatrix(20, 400000, slow);
+  int visible = 0;
+  for (uint8_t col = 0; col < LED_COLUMNS; col++)
+  {
+    CHECK(abs(fast[col] - slow[col]) <= 1);
+    visible += (fast[col] >= 0);
+  }
+  CHECK(visible >= LED_COLUMNS / 2);
+
+  return hostResult("test_animation");
+}
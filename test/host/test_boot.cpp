@@ -0,0 +1,45 @@
+/*
+  First frame after reset.
+
+  setup() has to show the full sentence of the RTC's time at full level
+  with its first strip update, no crossfade step pending.
+*/
+
+#include "host.h"
+
+int main()
+{
+  hostRTC.time.Hour = 14;
+  hostRTC.time.Minute = 23;
+  hostRTC.time.Wday = 3;
+  hostRTC.readMicros = 800;
+  host.micros = 120000; // bootloader and static initialization
+
+  setup();
+  CHECK(isTimeSynced);
+  CHECK_EQ(t.Minute, 23);
+  CHECK_EQ(host.shows, 1);
+  CHECK_EQ(crossfadeFrame, 0);
+  CHECK_EQ(telemetry.bootMillis, 120);
+  CHECK(hostMaskBit(timeMask, digitLed(DIGITS[2])));
+  CHECK(hostMaskBit(timeMask, digitLed(DIGITS[3])));
+
+  const CRGB lit = CHSV(hue, 255, 255);
+  int litPixels = 0;
+  for (int i = 0; i < LED_PIXELS; i++)
+  {
+    bool isLit = hostMaskBit(timeMask, i);
+    CHECK(leds[i] == (isLit ? lit : CRGB(CRGB::Black)));
+    litPixels += isLit;
+  }
+  CHECK(litPixels > 0);
+
+  // then the timer and the tasks, which find nothing new to show
+  CHECK(TIMSK1 & (1 << OCIE1A));
+  uint32_t shows = host.shows;
+  host.micros += 1000000;
+  loop();
+  CHECK_EQ(host.shows, shows); // nothing changed, nothing to show
+
+  return hostResult("test_boot");
+}
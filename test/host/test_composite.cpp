@@ -0,0 +1,74 @@
+/*
+  Animations composited with the time mask (LED_COMPOSITE).
+
+  For every minute of the day the pixels of the time have to keep the
+  animation, all others are cleared or dimmed. The power estimate of
+  the composited frame has to match a sum over the whole strip. Built
+  once per LED_COMPOSITE setting, see the Makefile.
+*/
+
+#include "host.h"
+
+#if LED_COMPOSITE == LED_COMPOSITE_DIM
+#define NAME "test_composite_dim"
+#else
+#define NAME "test_composite"
+#endif
+
+/**
+ * Animation stand-in, different for every pixel.
+ */
+CRGB pattern(int led)
+{
+  return CRGB(40 + (led % 200), 255 - (led % 128), 100);
+}
+
+CRGB background(int led)
+{
+#if LED_COMPOSITE == LED_COMPOSITE_DIM
+  CRGB dimmed = pattern(led);
+  return dimmed.nscale8(LED_COMPOSITE_DIM_SCALE);
+#else
+  (void)led;
+  return CRGB::Black;
+#endif
+}
+
+int main()
+{
+  isScheduleActive = false;
+  for (int hours = 0; hours < 24; hours++)
+  {
+    for (int minutes = 0; minutes < 60; minutes++)
+    {
+      hostSetTime(hours, minutes);
+      updateTime = true;
+      refreshTimeMask();
+      for (int i = 0; i < LED_PIXELS; i++)
+        leds[i] = pattern(i);
+      wordclock.compositeMask(leds, timeMask);
+      for (int i = 0; i < LED_PIXELS; i++)
+        CHECK(leds[i] == (hostMaskBit(timeMask, i) ? pattern(i) : background(i)));
+    }
+  }
+
+  // through handleLeds: a full-strip animation only shows in the words
+  setLEDModeState(LED_MODE_RAINBOW);
+  hostSetTime(7, 42);
+  updateTime = true;
+  host.micros += 20000;
+  handleLeds();
+#if LED_COMPOSITE == LED_COMPOSITE_ZERO
+  for (int i = 0; i < LED_PIXELS; i++)
+    CHECK((bool)leds[i] == hostMaskBit(timeMask, i));
+#endif
+  CHECK(hostMaskBit(timeMask, digitLed(DIGITS[4])));
+  CHECK(hostMaskBit(timeMask, digitLed(DIGITS[2])));
+
+  PowerEstimate full;
+  full.rescan(leds);
+  CHECK(full.milliamps(255) > LED_PIXELS * LED_POWER_IDLE);
+  CHECK_EQ(powerEstimate.milliamps(255), full.milliamps(255));
+
+  return hostResult(NAME);
+}
@@ -0,0 +1,75 @@
+/*
+  Crossfade between two times (LED_CROSSFADE_FRAMES).
+
+  Words of the new time fade in and words of the old one fade out over
+  LED_CROSSFADE_FRAMES frames, words in both stay lit. Built once more
+  with 0 frames, the time then switches with the first frame, see the
+  Makefile.
+*/
+
+#include "host.h"
+
+#if LED_CROSSFADE_FRAMES > 0
+#define NAME "test_crossfade"
+#else
+#define NAME "test_crossfade_off"
+#endif
+
+uint8_t fromMask[LED_MASK_BYTES];
+
+/**
+ * Fade from the shown time to the given one, checks every frame.
+ * Returns the frames until nothing changes anymore.
+ */
+int fadeTo(uint8_t hours, uint8_t minutes)
+{
+  memcpy(fromMask, timeMask, LED_MASK_BYTES);
+  hostSetTime(hours, minutes);
+  updateTime = true;
+
+  uint8_t last[LED_PIXELS];
+  for (int i = 0; i < LED_PIXELS; i++)
+    last[i] = hostMaskBit(fromMask, i) ? 255 : 0;
+
+  int frames = 0;
+  do
+  {
+    handleDisplayTime();
+    frames++;
+    for (int i = 0; i < LED_PIXELS; i++)
+    {
+      bool isFrom = hostMaskBit(fromMask, i), isTo = hostMaskBit(timeMask, i);
+      uint8_t level = leds[i].b; // value of the stand-in's CHSV
+      if (isFrom && isTo)
+        CHECK_EQ(level, 255);
+      else if (isTo)
+        CHECK(level >= last[i]); // fading in
+      else if (isFrom)
+        CHECK(level <= last[i]); // fading out
+      else
+        CHECK(!leds[i]);
+      last[i] = level;
+    }
+  } while (crossfadeFrame > 0);
+
+  for (int i = 0; i < LED_PIXELS; i++)
+    CHECK_EQ(last[i], hostMaskBit(timeMask, i) ? 255 : 0);
+  return frames;
+}
+
+int main()
+{
+  autoCycleHue = false;
+  isScheduleActive = false;
+  hostSetTime(10, 4);
+  updateTime = true;
+  handleDisplayTime();
+  while (crossfadeFrame > 0)
+    handleDisplayTime();
+
+  CHECK_EQ(fadeTo(10, 5), (LED_CROSSFADE_FRAMES > 0) ? LED_CROSSFADE_FRAMES : 1);
+  CHECK_EQ(fadeTo(10, 35), (LED_CROSSFADE_FRAMES > 0) ? LED_CROSSFADE_FRAMES : 1);
+  CHECK_EQ(fadeTo(11, 0), (LED_CROSSFADE_FRAMES > 0) ? LED_CROSSFADE_FRAMES : 1);
+
+  return hostResult(NAME);
+}
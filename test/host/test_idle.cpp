@@ -0,0 +1,29 @@
+/*
+  Idle sleep accounting (BOARD_IDLE_SLEEP with TELEMETRY).
+
+  loop() idles whenever no task was due. The counters sent with the
+  status frames have to match the sleeps of the fake board and are
+  cleared with every frame sent.
+*/
+
+#define BOARD_IDLE_SLEEP 1
+#define TELEMETRY 1
+#include "host.h"
+
+int main()
+{
+  host.idleMicros = 50; // IRremote's Timer2 tick
+  uint32_t idles = host.idles;
+  for (int i = 0; i < 1000; i++)
+    loop();
+  uint32_t slept = host.idles - idles;
+  CHECK(slept > 0);
+  CHECK_EQ(telemetry.idles, slept);
+  CHECK_EQ(telemetry.idleMicros, slept * 50);
+
+  handleTelemetry();
+  CHECK_EQ(telemetry.idles, 0);
+  CHECK_EQ(telemetry.idleMicros, 0);
+
+  return hostResult("test_idle");
+}
@@ -0,0 +1,102 @@
+/*
+  USART output (LED_OUTPUT_USART) against the fake USART0.
+
+  A frame has to be encoded as four symbol bits per WS2812B bit, leave
+  TXD driven low by the port, send a frame again after a gap of the
+  reset time, but not after shorter gaps or too often, and keep
+  IR decoding out of the Timer1 ISR while it is shifted out.
+*/
+
+#define LED_OUTPUT LED_OUTPUT_USART
+#include "host.h"
+
+/**
+ * WS2812B byte number n of the last frames, decoded from the symbols.
+ */
+uint8_t sentByte(int n)
+{
+  uint8_t b = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    uint8_t symbol = hostUsart.symbols[(n * 4) + i];
+    CHECK((symbol == 0x88) || (symbol == 0x8C) || (symbol == 0xC8) || (symbol == 0xCC));
+    b = (b << 2) | ((symbol & 0x40) ? 2 : 0) | ((symbol & 0x04) ? 1 : 0);
+  }
+  return b;
+}
+
+void clearUsart()
+{
+  memset(&hostUsart, 0, sizeof(hostUsart));
+}
+
+int main()
+{
+  FastLED.addLeds(&ledOutput, leds, LED_PIXELS);
+  FastLED.setBrightness(255);
+  CHECK(DDRD & (1 << DDD1));
+  CHECK(!(PORTD & (1 << PORTD1)));
+  CHECK(!(UCSR0B & (1 << TXEN0)));
+
+  // one frame in GRB order, transmitter off again afterwards
+  clearUsart();
+  fill_solid(leds, LED_PIXELS, CRGB::Black);
+  leds[0] = CRGB(0x12, 0x34, 0xA5);
+  leds[LED_PIXELS - 1] = CRGB(0xFF, 0x00, 0x81);
+  CHECK(showLeds());
+  CHECK_EQ(hostUsart.count, LED_PIXELS * 3 * 4);
+  CHECK_EQ(sentByte(0), 0x34);
+  CHECK_EQ(sentByte(1), 0x12);
+  CHECK_EQ(sentByte(2), 0xA5);
+  CHECK_EQ(sentByte(3), 0x00);
+  CHECK_EQ(sentByte((LED_PIXELS * 3) - 3), 0x00);
+  CHECK_EQ(sentByte((LED_PIXELS * 3) - 2), 0xFF);
+  CHECK_EQ(sentByte((LED_PIXELS * 3) - 1), 0x81);
+  CHECK(!(UCSR0B & (1 << TXEN0)));
+  CHECK(!ledOutput.isSending);
+
+  // a refill came too late: the frame has to be sent again
+  clearUsart();
+  hostUsart.gapAfter = 100;
+  hostUsart.gapMicros = LED_USART_RESET_US + 4;
+  CHECK(!showLeds());
+  CHECK_EQ(ledOutput.gaps, 1);
+  clearUsart();
+  CHECK(showLeds());
+
+  // an ISR delaying a refill well below the reset time is no gap
+  clearUsart();
+  hostUsart.gapAfter = 100;
+  hostUsart.gapMicros = 20;
+  CHECK(showLeds());
+  CHECK_EQ(ledOutput.gaps, 1);
+
+  // a steady ISR load does not resend the frame forever
+  for (int i = 0; i <= LED_USART_RESENDS; i++)
+  {
+    clearUsart();
+    hostUsart.gapAfter = 100;
+    hostUsart.gapMicros = 200;
+    CHECK_EQ(showLeds(), i == LED_USART_RESENDS);
+  }
+  clearUsart();
+  hostUsart.gapAfter = 100;
+  hostUsart.gapMicros = 200;
+  CHECK(!showLeds()); // counted from the start again
+
+  // no decoding while a frame is shifted out
+  uint32_t value;
+  while (irQueue.pop(value))
+  {
+  }
+  hostSendIR(0xFF30CF);
+  ledOutput.isSending = true;
+  TIMER1_COMPA_vect();
+  CHECK(hostIR.isPending);
+  ledOutput.isSending = false;
+  TIMER1_COMPA_vect();
+  CHECK(!hostIR.isPending);
+  CHECK(irQueue.pop(value) && (value == 0xFF30CF));
+
+  return hostResult("test_output");
+}
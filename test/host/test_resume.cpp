@@ -0,0 +1,26 @@
+/*
+  Resume time after the wake-up alarm (telemetry.resumeMicros).
+
+  resumeFromSleep shows the current time right away and records the
+  time from waking up to that frame. Longer resumes saturate instead of
+  wrapping around.
+*/
+
+#include "host.h"
+
+int main()
+{
+  hostSetTime(6, 0);
+  uint32_t shows = host.shows;
+  hostRTC.readMicros = 1200;
+  resumeFromSleep();
+  CHECK_EQ(telemetry.resumeMicros, 1200);
+  CHECK(host.shows > shows);
+  CHECK(hostMaskBit(timeMask, digitLed(DIGITS[0])));
+
+  hostRTC.readMicros = 70000; // e.g. a slow I2C bus
+  resumeFromSleep();
+  CHECK_EQ(telemetry.resumeMicros, 0xFFFF);
+
+  return hostResult("test_resume");
+}
@@ -0,0 +1,78 @@
+/*
+  Counting seconds from the square wave while the RTC cannot be read.
+
+  handleTime carries minutes, hours and the day of week itself, the
+  hourly RTC read only corrects it. A failed read must neither stop the
+  clock nor publish an invalid minute.
+*/
+
+#include "host.h"
+
+/**
+ * Let the square wave count seconds and run the time task.
+ */
+void tick(uint8_t seconds)
+{
+  sqwTicks += seconds;
+  handleTime();
+}
+
+int main()
+{
+  // synced at 23:59:50 on a Saturday, then the RTC stops answering
+  hostSetTime(23, 59, 7);
+  t.Second = 50;
+  hostRTC.readError = 2;
+  isTimeSynced = true;
+  updateTime = false;
+
+  tick(20);
+  CHECK_EQ(t.Hour, 0);
+  CHECK_EQ(t.Minute, 0);
+  CHECK_EQ(t.Second, 10);
+  CHECK_EQ(t.Wday, 1);
+  CHECK(!isTimeSynced);
+  CHECK(updateTime);
+
+  // two days without a single successful read
+  uint32_t reads = hostRTC.reads;
+  for (uint32_t i = 0; i < (2UL * 24 * 3600) / 200; i++)
+  {
+    tick(200);
+    CHECK(t.Minute < 60);
+    CHECK(t.Hour < 24);
+  }
+  CHECK_EQ(t.Hour, 0);
+  CHECK_EQ(t.Minute, 0);
+  CHECK_EQ(t.Second, 10);
+  CHECK_EQ(t.Wday, 3);
+  CHECK(hostRTC.reads > reads); // retried with every run
+
+  updateTime = true;
+  handleDisplayTime();
+  CHECK(hostMaskBit(timeMask, digitLed(DIGITS[0])));
+
+  // the RTC answers again and corrects the counted time
+  hostRTC.readError = 0;
+  hostRTC.time.Hour = 0;
+  hostRTC.time.Minute = 2;
+  hostRTC.time.Wday = 3;
+  tick(1);
+  CHECK(isTimeSynced);
+  CHECK_EQ(t.Minute, 2);
+
+  // a corrupted minute lights no digit instead of indexing past DIGITS
+  uint8_t mask[LED_MASK_BYTES];
+  for (int minutes = 60; minutes < 256; minutes++)
+  {
+    tmElements_t corrupted = {};
+    corrupted.Hour = 10;
+    corrupted.Minute = minutes;
+    memset(mask, 0, sizeof(mask));
+    wordclock.setTimeMask(mask, corrupted, false);
+    for (uint8_t i = 0; i < 10; i++)
+      CHECK(!hostMaskBit(mask, digitLed(DIGITS[i])));
+  }
+
+  return hostResult("test_resync");
+}
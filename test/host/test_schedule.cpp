@@ -0,0 +1,103 @@
+/*
+  Wake-up alarm of the weekly schedule.
+
+  From every minute of the week the clock sleeps at, Alarm 2 has to fire
+  exactly at the start of the next alive window. Within a day only hours
+  and minutes are matched, so a day of week register the RTC never had
+  set does not matter. A square wave edge while the 1 Hz output is
+  being stopped is a second, not the wake-up. Built once more with a
+  schedule of longer off periods, see the Makefile.
+*/
+
+#include "host.h"
+
+#ifdef NAME_SUFFIX
+#define NAME "test_schedule" NAME_SUFFIX
+#else
+#define NAME "test_schedule"
+#endif
+
+/**
+ * First minute of the week after now the programmed alarm matches at,
+ * for an RTC counting the day of week from wday. -1 if none within a week.
+ */
+int firstMatch(uint16_t now, uint8_t wday)
+{
+  for (uint16_t distance = 1; distance <= MINUTES_PER_WEEK; distance++)
+  {
+    uint16_t minute = (now + distance) % MINUTES_PER_WEEK;
+    uint16_t time = minute % MINUTES_PER_DAY;
+    uint8_t dow = ((wday - 1 + ((now % MINUTES_PER_DAY) + distance) / MINUTES_PER_DAY) % 7) + 1;
+    if ((time / 60 != hostRTC.alarmHours) || (time % 60 != hostRTC.alarmMinutes))
+      continue;
+    if ((hostRTC.alarmType == DS3232RTC::ALM2_MATCH_DAY) && (dow != hostRTC.alarmDayDate))
+      continue;
+    return minute;
+  }
+  return -1;
+}
+
+/**
+ * Falling edge of the 1 Hz output.
+ */
+void squareWaveEdge()
+{
+  isrAlarm();
+}
+
+int main()
+{
+  isScheduleActive = true;
+  int sleeping = 0, daily = 0;
+  for (uint8_t wday = 1; wday <= 7; wday++)
+  {
+    for (uint16_t time = 0; time < MINUTES_PER_DAY; time++)
+    {
+      tmElements_t tm = {};
+      tm.Wday = wday;
+      tm.Hour = time / 60;
+      tm.Minute = time % 60;
+      if (!wordclock.shouldGoToSleep(tm))
+        continue;
+      sleeping++;
+
+      uint16_t now = minuteOfWeek(wday, tm.Hour, tm.Minute);
+      uint16_t wakeUp = nextAliveMinute(now);
+      wordclock.setAlarmSchedule(theClock, tm);
+      CHECK(hostRTC.isAlarm2Enabled);
+      CHECK(isAliveAt(wakeUp));
+      CHECK_EQ(firstMatch(now, wday), wakeUp);
+
+      uint16_t distance = (wakeUp + MINUTES_PER_WEEK - now) % MINUTES_PER_WEEK;
+      CHECK_EQ(hostRTC.alarmType, (distance < MINUTES_PER_DAY) ? DS3232RTC::ALM2_MATCH_HOURS : DS3232RTC::ALM2_MATCH_DAY);
+      daily += (hostRTC.alarmType == DS3232RTC::ALM2_MATCH_HOURS);
+
+      // day of week register never set: wake up daily at the window's time
+      tm.Wday = 0;
+      wordclock.setAlarmSchedule(theClock, tm);
+      CHECK_EQ(hostRTC.alarmType, DS3232RTC::ALM2_MATCH_HOURS);
+      CHECK_EQ((hostRTC.alarmHours * 60) + hostRTC.alarmMinutes, nextAliveMinute(minuteOfWeek(0, tm.Hour, tm.Minute)) % MINUTES_PER_DAY);
+    }
+  }
+  CHECK(sleeping > 0);
+  CHECK(daily > 0);
+#ifdef NAME_SUFFIX
+  CHECK(daily < sleeping); // the variant has off periods longer than a day
+#endif
+
+  // an edge of the square wave while it is switched off for the alarm
+  tmElements_t tm = {};
+  tm.Wday = 1;
+  wordclock.enableSquareWave(theClock);
+  uint8_t ticks = sqwTicks;
+  isrAlarmWasCalled = false;
+  hostRTC.onSquareWave = squareWaveEdge;
+  wordclock.setAlarmSchedule(theClock, tm);
+  hostRTC.onSquareWave = NULL;
+  CHECK_EQ(hostRTC.squareWave, DS3232RTC::SQWAVE_NONE);
+  CHECK_EQ((uint8_t)(sqwTicks - ticks), 1);
+  CHECK(!isrAlarmWasCalled);
+  CHECK(!isSquareWaveActive);
+
+  return hostResult(NAME);
+}
@@ -0,0 +1,94 @@
+/*
+  Settings ring in EEPROM (SettingsStore).
+
+  Every boot has to find the newest complete record: on an erased ring,
+  over many rotations including the wrap of the sequence number, after
+  a write torn by a power failure, and no write may happen for
+  unchanged settings.
+*/
+
+#include "host.h"
+
+/**
+ * Save a record the way handleSettings does, until all bytes are written.
+ */
+void saveAll(SettingsStore &store, uint8_t hue)
+{
+  SettingsRecord record = {};
+  record.ledMode = LED_MODE_RAINBOW;
+  record.hue = hue;
+  record.brightness = 42;
+  record.flags = SETTINGS_FLAG_AUTO_HUE;
+  store.save(record);
+  for (int i = 0; i < 2 * (int)sizeof(SettingsRecord); i++)
+    store.run(); // a byte per call, extra calls do nothing
+}
+
+int main()
+{
+  memset(hostEeprom, 0xFF, sizeof(hostEeprom)); // erased
+  SettingsRecord loaded;
+  {
+    SettingsStore store;
+    CHECK(!store.load(loaded));
+  }
+
+  // every boot continues the ring of the one before
+  uint32_t writes = hostEepromWrites;
+  for (int n = 0; n < 40 * SETTINGS_SLOTS; n++)
+  {
+    SettingsStore store;
+    store.load(loaded);
+    saveAll(store, n);
+
+    SettingsStore next;
+    CHECK(next.load(loaded));
+    CHECK_EQ(loaded.hue, (uint8_t)n);
+  }
+  CHECK(hostEepromWrites - writes <= 40UL * SETTINGS_SLOTS * sizeof(SettingsRecord));
+  for (int slot = 0; slot < SETTINGS_SLOTS; slot++)
+  {
+    const SettingsRecord &record = ((const SettingsRecord *)(hostEeprom + SETTINGS_ADDRESS))[slot];
+    CHECK_EQ(record.version, SETTINGS_VERSION); // all slots in use
+  }
+
+  // power fails after three bytes of the next record
+  {
+    SettingsStore store;
+    store.load(loaded);
+    hostEepromBudget = 3;
+    saveAll(store, 200);
+    hostEepromBudget = -1;
+  }
+  {
+    SettingsStore store;
+    CHECK(store.load(loaded));
+    CHECK_EQ(loaded.hue, (uint8_t)((40 * SETTINGS_SLOTS) - 1));
+
+    // the same settings again: nothing to write
+    writes = hostEepromWrites;
+    saveAll(store, loaded.hue);
+    CHECK_EQ(hostEepromWrites, writes);
+    CHECK(!store.isWriting());
+  }
+
+  // through the sketch: a change is saved SETTINGS_DELAY after the last key
+  restoreSettings();
+  CHECK_EQ(ledMode, LED_MODE_RAINBOW);
+  CHECK_EQ(newBrightness, 42);
+  hue = 99;
+  settings.touch();
+  writes = hostEepromWrites;
+  host.micros += (SETTINGS_DELAY - 100) * 1000UL;
+  handleSettings();
+  CHECK_EQ(hostEepromWrites, writes);
+  host.micros += 200 * 1000UL;
+  for (int i = 0; i < 20; i++)
+    handleSettings();
+  CHECK(hostEepromWrites > writes);
+  SettingsStore store;
+  CHECK(store.load(loaded));
+  CHECK_EQ(loaded.hue, 99);
+
+  return hostResult("test_settings");
+}
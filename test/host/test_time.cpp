@@ -0,0 +1,122 @@
+/*
+  Every minute of the day through handleDisplayTime.
+
+  The reference below is the per-word render chain the frame masks
+  replaced (setColorForFiveMinuteStep, setColorForRelation, ... of the
+  first versions), written against the word tables. The shown frame has
+  to light exactly its words in the time's color, once the crossfade is
+  done. Built once more for the larger faces in faces/, see the Makefile.
+*/
+
+#include "host.h"
+
+#ifdef NAME_SUFFIX
+#define NAME "test_time" NAME_SUFFIX
+#else
+#define NAME "test_time"
+#endif
+
+bool expected[LED_PIXELS];
+
+void light(const Word &w)
+{
+  for (uint8_t i = 0; i < wordSize(w); i++)
+    expected[wordLed(w, i)] = true;
+}
+
+void referenceSentence(int hours, int minutes, bool withSchedule)
+{
+  memset(expected, 0, sizeof(expected));
+  light(IT);
+  light(IS);
+
+  if ((minutes < 56) || (minutes == 0))
+  {
+    int step = (minutes < 30)   ? (minutes / MIN_STEP)
+               : (minutes > 30) ? ((MIN_PARTS - 2) - ((minutes - 31) / MIN_STEP))
+                                : 5; // half
+    light(W_MINS[step]);
+    light((minutes > 30) ? TO : PAST);
+  }
+
+  light(W_HOURS[((minutes > 30) ? (hours + 1) : hours) % 12]);
+  light((hours > 12) ? PM : AM);
+
+  expected[digitLed(DIGITS[minutes / 10])] = true;
+  expected[digitLed(DIGITS[minutes % 10])] = true;
+  if (withSchedule)
+    expected[digitLed(SCHEDULE)] = true;
+}
+
+/**
+ * Show the time and compare the settled frame with the reference.
+ * Returns the frames the change took.
+ */
+int checkMinute(int hours, int minutes, bool withSchedule)
+{
+  hostSetTime(hours, minutes);
+  isScheduleActive = withSchedule;
+  updateTime = true;
+
+  int frames = 0;
+  do
+  {
+    handleDisplayTime();
+    frames++;
+  } while (crossfadeFrame > 0);
+
+  referenceSentence(hours, minutes, withSchedule);
+  const CRGB lit = CHSV(hue, 255, 255);
+  for (int i = 0; i < LED_PIXELS; i++)
+  {
+    bool isLit = (leds[i] == lit);
+    if (isLit != expected[i])
+      fprintf(stderr, "%02d:%02d pixel %d is %s\n", hours, minutes, i, isLit ? "lit" : "dark");
+    CHECK(isLit == expected[i]);
+    CHECK(isLit || !leds[i]); // nothing half faded is left
+    CHECK_EQ(hostMaskBit(timeMask, i), expected[i]);
+  }
+  return frames;
+}
+
+int main()
+{
+  hue = 7;
+  int longest = 0;
+  for (int hours = 0; hours < 24; hours++)
+  {
+    for (int minutes = 0; minutes < 60; minutes++)
+    {
+      CHECK_EQ(wordclock.shouldShowMinutes(minutes), (minutes < 56) || (minutes == 0));
+      int frames = checkMinute(hours, minutes, false);
+      if (frames > longest)
+        longest = frames;
+    }
+  }
+  CHECK(longest <= LED_CROSSFADE_FRAMES + 1);
+
+  // the schedule indicator is part of the mask
+  checkMinute(6, 30, true);
+  checkMinute(23, 59, true);
+
+  // unchanged time: no recompute, no recolor, nothing to show
+  hostSetTime(10, 10);
+  updateTime = true;
+  handleDisplayTime();
+  while (crossfadeFrame > 0)
+    handleDisplayTime();
+  CRGB before[LED_PIXELS];
+  memcpy(before, leds, sizeof(leds));
+  leds[0] = CRGB(1, 2, 3); // would be overwritten by a recolor
+  handleDisplayTime();
+  CHECK(leds[0] == CRGB(1, 2, 3));
+  leds[0] = before[0];
+
+  // a hue change recolors the cached mask without recomputing it
+  hue = 99;
+  handleDisplayTime();
+  for (int i = 0; i < LED_PIXELS; i++)
+    CHECK(hostMaskBit(timeMask, i) ? (leds[i] == CRGB(CHSV(99, 255, 255))) : !leds[i]);
+
+  return hostResult(NAME);
+}
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+Generate the word and digit tables of the wordclock from a layout file.
+
+    python3 tools/layout.py tools/layout_en.txt > wordclock_layout.h
+    python3 tools/layout.py tools/layout_en.txt --svg wordclock_en_384x384.svg
+
+The layout file holds the letter grid and which letters form the words,
+see tools/layout_en.txt. The generated header defines the PROGMEM tables
+used by wordclock_constants.h, the frame masks and the XY mapping are
+derived from them at compile time.
+
+With --svg the grid is checked against the template: the glyphs are
+outlines, so only their amount and positions (rows and columns) can be
+compared, not the letters themselves.
+"""
+
+import argparse
+import re
+import sys
+
+
+class LayoutError(Exception):
+    pass
+
+
+class Layout:
+    def __init__(self):
+        self.grid = []
+        self.items = []  # (kind, name, data, comment) in file order
+
+    @property
+    def rows(self):
+        return len(self.grid)
+
+    @property
+    def columns(self):
+        return len(self.grid[0]) if self.grid else 0
+
+    def led(self, row, col):
+        """Strip index of a cell, rows alternate their direction."""
+        if (row % 2) == 0:
+            return (row * self.columns) + col
+        return (row * self.columns) + (self.columns - 1 - col)
+
+    def cells(self, part):
+        """Cells of a part, either ROW,COLUMN or TEXT[@ROW]."""
+        match = re.fullmatch(r"(\d+),(\d+)", part)
+        if match:
+            row, col = int(match.group(1)), int(match.group(2))
+            if row >= self.rows or col >= self.columns:
+                raise LayoutError("cell %s is outside the grid" % part)
+            return [(row, col)]
+
+        text, _, row = part.partition("@")
+        rows = [int(row)] if row else range(self.rows)
+        found = []
+        for r in rows:
+            start = self.grid[r].find(text)
+            while start >= 0:
+                found.append(r)
+                found.append(start)
+                start = self.grid[r].find(text, start + 1)
+        if not found:
+            raise LayoutError("'%s' not found in the grid" % part)
+        if len(found) > 2:
+            raise LayoutError("'%s' is ambiguous, add @ROW" % part)
+        return [(found[0], found[1] + i) for i in range(len(text))]
+
+    def leds(self, parts):
+        return [self.led(r, c) for part in parts for r, c in self.cells(part)]
+
+
+def parse(lines):
+    layout = Layout()
+    group = None
+    for number, line in enumerate(lines, 1):
+        line, _, comment = line.partition("#")
+        comment = comment.strip()
+        fields = line.split()
+        if not fields:
+            continue
+        try:
+            keyword, args = fields[0], fields[1:]
+            if group is not None:
+                if keyword == "end":
+                    layout.items.append(("words", group[0], group[1], None))
+                    group = None
+                else:
+                    group[1].append((keyword, args, comment))
+            elif keyword == "grid":
+                if layout.grid and len(args[0]) != layout.columns:
+                    raise LayoutError("rows have to be of equal length")
+                layout.grid.append(args[0])
+            elif keyword == "word":
+                layout.items.append(("word", args[0], args[1:], comment))
+            elif keyword == "words":
+                group = (args[0], [])
+            elif keyword in ("digit", "digits"):
+                layout.items.append((keyword, args[0], (args[1], args[2]), comment))
+            else:
+                raise LayoutError("unknown keyword '%s'" % keyword)
+        except (LayoutError, IndexError) as error:
+            raise LayoutError("line %d: %s" % (number, error or "missing argument"))
+    if group is not None:
+        raise LayoutError("'words %s' is missing its 'end'" % group[0])
+    return layout
+
+
+def indexes(name, leds, comment):
+    line = "INDEXES(%s, %s);" % (name, ", ".join(str(led) for led in leds))
+    return line + (" // " + comment if comment else "")
+
+
+def generate(layout, source):
+    out = [
+        "#ifndef WORDCLOCK_LAYOUT_HEADER",
+        "#define WORDCLOCK_LAYOUT_HEADER",
+        "",
+        "/*",
+        "  Generated by tools/layout.py from %s, do not edit." % source,
+        "",
+    ]
+    out += ["    " + row for row in layout.grid]
+    out += ["*/", "", "static_assert(LED_ROWS == %d && LED_COLUMNS == %d, \"layout does not match the matrix\");" % (layout.rows, layout.columns), ""]
+
+    for kind, name, data, comment in layout.items:
+        if kind == "word":
+            out.append(indexes(name, layout.leds(data), comment))
+            out.append("constexpr Word %s PROGMEM = WORD(%s);" % (name, name))
+        elif kind == "words":
+            entries = []
+            for entry, parts, entry_comment in data:
+                out.append(indexes(entry, layout.leds(parts), entry_comment))
+                entries.append("WORD(%s)" % entry)
+            lines = [", ".join(entries[i:i + 3]) for i in range(0, len(entries), 3)]
+            out.append("constexpr Word %s[] PROGMEM = {" % name)
+            out.append("    " + ",\n    ".join(lines) + "};")
+        elif kind == "digit":
+            label, part = data
+            (led,) = layout.leds([part])
+            out.append("LABEL(%s);" % label)
+            out.append("constexpr Digit %s PROGMEM = {T_%s, %d};%s" % (name, label, led, " // " + comment if comment else ""))
+        elif kind == "digits":
+            prefix, part = data
+            text, _, row = part.partition("@")
+            digits = []
+            for i, letter in enumerate(text):
+                (led,) = layout.leds([letter + ("@" + row if row else "")])
+                out.append("LABEL(%s%d);" % (prefix, i))
+                digits.append("{T_%s%d, %d}" % (prefix, i, led))
+            out.append("constexpr Digit %s[] PROGMEM = {" % name)
+            out.append("    " + ", ".join(digits) + "};")
+        out.append("")
+
+    out.append("#endif")
+    return "\n".join(out) + "\n"
+
+
+def check_svg(layout, path):
+    """Compare rows and columns of the glyphs in the SVG with the grid."""
+    svg = open(path).read()
+    centers = []
+    for tx, ty, shape in re.findall(r'<g transform="matrix\(1,0,0,1,([-\d.]+),([-\d.]+)\)">\s*<(?:path|rect)([^>]*)/>', svg):
+        d = re.search(r' d="([^"]*)"', shape)
+        if d:
+            numbers = [float(n) for n in re.findall(r"-?\d+\.?\d*", d.group(1))]
+            xs, ys = numbers[0::2], numbers[1::2]
+        else:
+            x = float(re.search(r' x="([-\d.]+)"', shape).group(1))
+            y = float(re.search(r' y="([-\d.]+)"', shape).group(1))
+            xs = [x, x + float(re.search(r'width="([-\d.]+)"', shape).group(1))]
+            ys = [y, y + float(re.search(r'height="([-\d.]+)"', shape).group(1))]
+        centers.append(((min(xs) + max(xs)) / 2 + float(tx), (min(ys) + max(ys)) / 2 + float(ty)))
+
+    if len(centers) != layout.rows * layout.columns:
+        raise LayoutError("%s has %d glyphs, the grid %d letters" % (path, len(centers), layout.rows * layout.columns))
+
+    def lines(values, count):
+        low, high = min(values), max(values)
+        pitch = (high - low) / (count - 1)
+        return [round((v - low) / pitch) for v in values]
+
+    cells = set(zip(lines([y for _, y in centers], layout.rows), lines([x for x, _ in centers], layout.columns)))
+    if len(cells) != len(centers):
+        raise LayoutError("glyphs of %s do not form a %dx%d grid" % (path, layout.rows, layout.columns))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("layout", help="layout file, e.g. tools/layout_en.txt")
+    parser.add_argument("--svg", help="check the grid against this template")
+    args = parser.parse_args()
+
+    try:
+        with open(args.layout) as f:
+            layout = parse(f)
+        if args.svg:
+            check_svg(layout, args.svg)
+            return
+        sys.stdout.write(generate(layout, args.layout))
+    except LayoutError as error:
+        sys.exit("%s: %s" % (args.layout, error))
+
+
+if __name__ == "__main__":
+    main()
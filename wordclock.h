@@ -1,14 +1,6 @@
 #ifndef WORDCLOCK_HEADER
 #define WORDCLOCK_HEADER
 
-/* External */
-#include <math.h>
-#include <IRremote.h>
-#include <DS3232RTC.h> // Analog 4, Analog 5 for Arduino Nano, Digital 2 to react on interrupt
-#include <FastLED.h>
-#include <Enerlib.h>
-
-/* Internal */
 // Content:
 // Definitions
 // Pin and value definitions for:
@@ -17,33 +9,138 @@
 //      - LED animation modes
 //      - RTC
 //      - IR
+// Included first, they select drivers of the external libraries
 #include "wordclock_definitions.h"
 
+/* External */
+#include <math.h>
+#include <IRremote.h>
+#include <DS3232RTC.h> // Analog 4, Analog 5 for Arduino Nano, Digital 2 to react on interrupt
+#if BOARD_ESP32 && (LED_OUTPUT == LED_OUTPUT_I2S)
+#define FASTLED_ESP32_I2S true
+#endif
+#include <FastLED.h>
+#if !BOARD_ESP32
+#include <Enerlib.h>
+#endif
+
+/* Internal */
+
+// Content:
+// ESP32 target, only with BOARD_ESP32
+//      - Frame, handed over to the output task
+//      - Energy and avr/eeprom.h replacements
+#if BOARD_ESP32
+#include "wordclock_esp32.h"
+#endif
+
+// Content:
+// Matrix
+//      - Geometry, sizes, index type and XY lookup table (PROGMEM) of a face
+//      - LedMatrix, 2D view over the leds
+#include "wordclock_matrix.h"
+
 // Content:
 // Structures
 //      - Word
 //      - Digit
 // Macros
+// Accessors for PROGMEM words and digits
+// Word and digit tables (LED_LAYOUT, generated)
+// Frame masks (PROGMEM)
+// WordLayout
 #include "wordclock_constants.h"
 
+// Content:
+// Time to word mapping
+//      - Frame step for the minutes
+//      - Time mask from the PROGMEM frame masks
+#include "wordclock_mask.h"
+
+// Content:
+// Schedule
+//      - AliveWindow table (PROGMEM), when the clock is lit
+//      - Minute of week, next wake-up
+#include "wordclock_schedule.h"
+
+// Content:
+// LED output
+//      - USART/SPI driver for WS2812B, if LED_OUTPUT_USART is selected
+#include "wordclock_output.h"
+
+// Content:
+// Timer
+//      - Compile-time prescaler and compare value for Timer1
+//      - Tick counter
+#include "wordclock_timer.h"
+
+// Content:
+// Queue
+//      - RingBuffer, lock-free single producer/single consumer
+//      - Mailbox, lock-free hand-over of the latest value
+#include "wordclock_queue.h"
+
+// Content:
+// Animation clock
+//      - AnimationClock, frame-rate independent rates in 8.8 fixed point
+#include "wordclock_animation.h"
+
+// Content:
+// Power
+//      - PowerEstimate, incremental current estimate and brightness limit
+#include "wordclock_power.h"
+
+// Content:
+// Scheduler
+//      - Task
+//      - Scheduler, fixed task slots with micros() deadlines
+#include "wordclock_scheduler.h"
+
+// Content:
+// Profiler
+//      - StageStats, min/max/mean per stage
+//      - Profiler, only used with DEBUG_PROFILE
+#include "wordclock_profiler.h"
+
+// Content:
+// Debug log
+//      - LogEntry
+//      - DebugLog, events printed without blocking while idle
+#include "wordclock_log.h"
+
+// Content:
+// Telemetry
+//      - TelemetryCounters
+//      - TelemetryFrame, binary status frame with checksum
+#include "wordclock_telemetry.h"
+
+// Content:
+// Settings
+//      - SettingsRecord
+//      - SettingsStore, coalesced non-blocking writes into an EEPROM ring
+#include "wordclock_settings.h"
+
 /* RTC */
-volatile bool updateTime = false;
+bool updateTime = true; // minute changed, the time mask has to be recomputed
 volatile bool isrAlarmWasCalled = false;
+volatile bool isSquareWaveActive = false; // INT/SQW pin outputs 1 Hz instead of alarm interrupts
+volatile uint8_t sqwTicks = 0;            // seconds counted by isrAlarm, wraps around
+uint8_t sqwTicksSeen = 0;                 // sqwTicks at the last time update
 
-bool isTimeUpdateRunning = false;
-bool isScheduleActive = true;
-bool isPowerOffInitialized = false;
+bool isTimeSynced = false; // t holds a full read of the RTC, only seconds are counted since
+volatile bool isScheduleActive = true;       // read by the control task on ESP32
+volatile bool isPowerOffInitialized = false; // set by the control task, read by the render task
 
 tmElements_t t;
 
 /* IR remote */
-decode_results irResults;
+decode_results irResults; // only used from within the timer ISR
+RingBuffer<uint32_t, IR_QUEUE_SIZE> irQueue; // decoded NEC values, filled by the timer ISR
 
-volatile bool shouldEvaluateIRresults = false;
-volatile byte irCtr = 0;
+volatile bool irNoiseReceived = false; // UNKNOWN signal decoded, see work-around in handleIRresults
+uint32_t irPausedAt = 0; // ticks
 
-bool evaluatingIRresults = false;
-bool pauseAnimations = false;
+volatile bool pauseAnimations = false; // set by the IR task, read by the control task on ESP32
 bool autoCycleHue = true;
 bool autoCycleBrightness = false;
 
@@ -75,38 +172,70 @@ const uint16_t IR_DOWN = 0x2FF6;
 const uint16_t IR_POWER = 0x2FD0;
 const uint16_t IR_AUTO_HUE = 0x2FD6;
 const uint16_t IR_AUTO_BRIGHTNESS = 0x2FEA;
+const uint32_t IR_REPEAT = 0xFFFFFFFF; // NEC repeat code, sent while a key is held
+
+uint16_t irLastKey = 0;  // key repeat codes refer to
+uint8_t irHoldCount = 0; // repeat codes received for irLastKey
 
 /* LED */
 bool blinkToConfirm = false;
-uint8_t fps = 60;
-uint8_t ledMode = LED_MODE_NORMAL;
+bool isConfirmShown = false;
+uint32_t confirmShownAt = 0; // ms
+uint8_t ledMode = LED_MODE_NORMAL; // index into LED_MODES
 uint8_t hue = 0;            // FastLED's HSV range is from [0...255], instead of common [0...359]
 uint8_t oldBrightness = 20; // in %, to avoid division will be multiplied by 0.01 before application, used for value of HSV color
 uint8_t newBrightness = 20;
 bool incBrightness = true;
+uint16_t hueFraction = 0;        // 8.8 fixed point remainders of the animation clock
+uint16_t brightnessFraction = 0;
+uint8_t timeMask[LED_MASK_BYTES]; // pixels of the current time sentence, one bit per pixel
+uint8_t previousMask[LED_MASK_BYTES]; // time sentence before the last refresh, faded out
+uint8_t crossfadeFrame = 0;           // frames left of the crossfade, 0 when done
+bool isFrameDirty = true;         // leds differ from what was last sent to the strip
+uint8_t maskHue = 0;              // hue the time mask was last colored with
+
+/* Telemetry */
+TelemetryCounters telemetry = {};
+uint32_t telemetrySentAt = 0; // us
 
 // ===================================
+/**
+ * Clock for a face of Rows x Cols pixels showing the words of Layout
+ * (e.g. WordLayout). Loop bounds, index types and the XY map are fixed
+ * at compile time for the given geometry.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
 class Wordclock
 {
+  typedef Geometry<Rows, Cols> Panel;
+  static_assert((Layout::Grid::ROWS == Rows) && (Layout::Grid::COLUMNS == Cols), "Layout does not match the face");
+
 public:
-  Wordclock(){};
+  Wordclock() : drops(), fadeFraction(0){};
   ~Wordclock(){};
 
   /* Time and power management */
   void initRTC(DS3232RTC &theClock);
-  void setRtcTime(DS3232RTC &theClock, int hours, int min);
-  void setAlarmSchedule(DS3232RTC &theClock);
-  void setAlarmScheduleAndEnterLowPower(DS3232RTC &theClock, Energy &energy);
+  void enableSquareWave(DS3232RTC &theClock);
+  bool advanceTime(tmElements_t &tm, uint8_t seconds);
+  void setRtcTime(DS3232RTC &theClock, int hours, int min, int wday = 1);
+  void setAlarmSchedule(DS3232RTC &theClock, tmElements_t &tm);
+  void setAlarmScheduleAndEnterLowPower(DS3232RTC &theClock, tmElements_t &tm, Energy &energy);
   void enterLowPower(Energy &energy);
+  void enterIdle(Energy &energy);
   bool shouldShowMinutes(int mins);
   bool shouldGoToSleep(tmElements_t &tm);
+  void setTimeMask(uint8_t *mask, tmElements_t &tm, bool withSchedule);
 
   /* LED managament */
   void increaseBrightness(int stepSize);
   void increaseHue(int stepSize);
-  void setColorForWord(CRGB *leds, Word _word);
-  void setColorForWord(CRGB *leds, const struct CRGB color, Word _word);
-  void setColorForDigit(CRGB *leds, Digit digit);
+  void setColorForWord(CRGB *leds, const Word &_word);
+  void setColorForWord(CRGB *leds, const struct CRGB color, const Word &_word);
+  void setColorForDigit(CRGB *leds, const Digit &digit);
+  void setColorForMask(CRGB *leds, const uint8_t *mask);
+  void compositeMask(CRGB *leds, const uint8_t *mask);
+  void crossfadeMask(CRGB *leds, const uint8_t *from, const uint8_t *to, uint8_t level);
 
   /* LED animation management*/
   void rainbow(CRGB *leds);
@@ -118,10 +247,16 @@ public:
   void matrix(CRGB *leds);
 
 private:
-  addGlitter(CRGB *leds, fract8 chanceOfGlitter) 
+  Drop drops[Cols];        // state of the matrix animation, one drop per column
+  uint16_t fadeFraction;   // 8.8 fixed point remainder of the trails' fading
+
+  void setPixel(CRGB *leds, uint16_t ledNo, const struct CRGB &color);
+  void spawnDrop(Drop &drop);
+
+  void addGlitter(CRGB *leds, fract8 chanceOfGlitter)
   {
     if (random8() < chanceOfGlitter)
-      leds[random16(LED_PIXELS)] += CRGB::White;
+      leds[random16(Panel::PIXELS)] += CRGB::White;
   }
 };
 
@@ -131,11 +266,14 @@ private:
 
 /**
  * Main function to determine which words to highlight to show time.
+ * Only recomputes the time mask on minute changes and
+ * only recolors it when the hue has changed.
  */
 void handleDisplayTime();
 
 /**
  * Main function to evaluate IR results.
+ * Drains all values queued by the timer ISR.
  */
 void handleIRresults();
 
@@ -145,13 +283,118 @@ void handleIRresults();
 void evaluateIRResult(uint32_t result);
 
 /**
- * Set values for selected LED mode.
+ * Add brightness or hue steps for the given key, scaled by factor.
+ * Returns false if the key is no adjustment.
  */
-void setLEDModeState(String debugMsg, uint8_t mode, uint8_t _fps);
+bool accumulateIRAdjustment(uint16_t key, uint8_t factor, int16_t &brightnessDelta, int16_t &hueDelta);
+
+/**
+ * Switch to an LED mode, its frame rate is taken from LED_MODES.
+ */
+void setLEDModeState(uint8_t mode);
+
+/**
+ * Render functions of the animation modes, see LED_MODES.
+ */
+void renderRainbow();
+void renderRainbowWithGlitter();
+void renderConfetti();
+void renderSinelon();
+void renderBpm();
+void renderJuggle();
+void renderMatrix();
 
 /**
  * Main function to decide what should be displayed.
  */
 void handleLeds();
 
+/**
+ * Recompute the time mask after the minute changed.
+ * Returns true when it was recomputed.
+ */
+bool refreshTimeMask();
+
+/**
+ * Read the time from the RTC.
+ * Returns false if it could not be read, t is unchanged then.
+ */
+bool readTime();
+
+/**
+ * Render and show the current time or animation right away, without crossfade.
+ */
+void showFrameNow();
+
+/**
+ * Restore the display after the board was woken up by the alarm.
+ */
+void resumeFromSleep();
+void recordResume(uint32_t since);
+
+/**
+ * Task to render and show the next frame.
+ */
+void handleRender();
+
+/**
+ * Task to read the current time from the RTC.
+ */
+void handleTime();
+
+/**
+ * Task to check whether the LEDs should be turned off.
+ */
+void handleSchedule();
+
+/**
+ * Let the render task redraw the time after t changed.
+ */
+void publishTime();
+
+/**
+ * Send leds to the strip, on ESP32 hand them over to the output task.
+ * Returns false while the output task did not take the previous frame yet,
+ * or if the USART output had a gap of the latch time and the frame has to be sent again.
+ */
+bool showLeds();
+
+/**
+ * Apply the settings saved in EEPROM, keeps the defaults if there are none.
+ */
+void restoreSettings();
+
+/**
+ * Task to save changed settings to EEPROM.
+ */
+void handleSettings();
+
+/**
+ * Task to send a status frame and start counting the next period.
+ */
+void handleTelemetry();
+
+/**
+ * React on a command byte received over Serial.
+ */
+void handleSerialCommand(int command);
+
+#if BOARD_ESP32
+/**
+ * Task on ESP32_CONTROL_CORE: IR decoding, time and schedule tasks.
+ */
+void controlLoop(void *parameters);
+
+/**
+ * Task on ESP32_OUTPUT_CORE: shows the frames handed over by showLeds.
+ */
+void outputLoop(void *parameters);
+#endif
+
+// Content:
+// LED modes, after the IR keys and handlers they refer to
+//      - LedModeInfo
+//      - LED_MODES registry (PROGMEM): render function, fps, flags and IR key per mode
+#include "wordclock_modes.h"
+
 #endif
\ No newline at end of file
@@ -13,7 +13,7 @@
  *
  * Author: Christian Hansen
  * Date: 10.2023
- * Version: 0.5
+ * Version: 0.6
  *
  *  Hardware:
  *  - Arduino Nano
@@ -29,6 +29,40 @@
  *
  *  Version  Description
  *  =======  ===========
+ *  0.6      * Precomputed frame masks (PROGMEM) for the time sentences, replacing the per-word render chain
+ *           * Dirty-frame tracking, the strip is only updated when pixels or brightness changed
+ *           * Optional USART/SPI output for the strip which keeps interrupts enabled (LED_OUTPUT_USART)
+ *           * Cooperative scheduler for render, IR, time and schedule tasks, replacing the blocking frame delay
+ *           * Count seconds from the RTC's 1 Hz square wave, the RTC is only read to sync once an hour (RTC_SQW_CLOCK)
+ *           * Time is only rendered on minute changes, hue changes only recolor the cached time mask
+ *           * Optional idle sleep while no task is due (BOARD_IDLE_SLEEP, off by default), idle entries and time are sent with telemetry
+ *           * Compile-time XY lookup table and 2D view for matrix effects, fixes skipped first row and column
+ *           * Matrix animation rendered from per-column drops, runs at 60 fps
+ *           * Word tables, labels and debug strings moved to PROGMEM
+ *           * IR values are queued by the timer ISR and drained by the IR task
+ *           * Held brightness/hue keys are batched into one accelerated adjustment per IR task run
+ *           * Timer1 tick service with compile-time checked prescaler, fixes overflowing compare value
+ *           * Frame-rate independent animation clock for hue/brightness cycling, fading trails and matrix drops
+ *           * Cycling the time's color steps once per new time (LED_AUTO_HUE_STEP), normal mode shows once a minute
+ *           * Faster bpm kernel reading the palette from flash per section, fading trails skip empty steps
+ *           * Per-stage frame-time profiler, dumped over Serial on 'p' (DEBUG_PROFILE)
+ *           * Time to word mapping moved into a hardware independent header
+ *           * Debug output is logged to a RAM ring buffer and printed while idle, at 115200 baud
+ *           * Binary status frames with IR, RTC, frame rate and sleep counters (TELEMETRY)
+ *           * Animations are composited with the time mask, so the time stays readable (LED_COMPOSITE)
+ *           * Crossfade between two times, only the changed pixels are updated (LED_CROSSFADE_FRAMES)
+ *           * Estimated strip current limits the brightness to the supply's budget (LED_POWER_BUDGET)
+ *           * Weekly schedule with several alive windows, the RTC wakes the board at the next window
+ *           * Fix sleep check treating e.g. 23:10 as awake
+ *           * Resume path after the wake-up alarm, shows the current time with the first strip update
+ *           * Faster boot: Serial only for debugging/telemetry, first frame is shown before IR and Timer1 are set up
+ *           * Settings are kept in an EEPROM ring, saved a few seconds after the last key press
+ *           * Word and digit tables are generated from a layout file of the template (tools/layout.py)
+ *           * Wordclock<Rows, Cols, Layout> is specialized per face at compile time, allows larger faces than 11 x 11
+ *           * ESP32 target, not yet compiled: frames are handed to an output task (RMT/I2S), IR, time and schedule run on the other core (BOARD_ESP32)
+ *           * LED modes registry (PROGMEM) with render function, fps, flags and IR key per mode, replacing the mode switches
+ *           * Host build against stub libraries with tests and kernel benchmarks (test/host)
+ *
  *  0.5      * Better organisation: introduced a "Wordclock" class, split defintions of header file into seperate files
  *
  *  0.4      * Move defnitions into separate header file
@@ -56,29 +90,103 @@ FASTLED_USING_NAMESPACE
 
 /* Control flags */
 #define DEBUG 0
+#define DEBUG_PROFILE 0 // measure stages of the main loop, needs DEBUG
+#define DEBUG_BAUD 115200
+#define DEBUG_LOG_SIZE 16 // events buffered until the next idle time, power of two
 #define SET_TIMER 0 // Set to 1 if only time should be set
+#ifndef TELEMETRY
+#define TELEMETRY 0 // send binary status frames over Serial, see wordclock_telemetry.h
+#endif
 
 /* Debug macro */
 #if DEBUG
 #define DBG_PRINT(...) Serial.print(__VA_ARGS__)
 #define DBG_PRINTLN(...) Serial.println(__VA_ARGS__)
+#define DBG_LOG(text, value) debugLog.record(text, value, DEC)
+#define DBG_LOG_HEX(text, value) debugLog.record(text, value, HEX)
 #else
 #define DBG_PRINT(...)
 #define DBG_PRINTLN(...)
+#define DBG_LOG(text, value)
+#define DBG_LOG_HEX(text, value)
+#endif
+
+#if DEBUG_PROFILE
+#define PROFILE_BEGIN(stage) profiler.begin(stage)
+#define PROFILE_END(stage) profiler.end(stage)
+#else
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#endif
+
+#if DEBUG_PROFILE && !DEBUG
+#error "DEBUG_PROFILE prints over Serial, enable DEBUG as well"
+#endif
+
+#if DEBUG && (LED_OUTPUT == LED_OUTPUT_USART)
+#error "LED_OUTPUT_USART occupies USART0, Serial cannot be used for debugging"
+#endif
+
+#if TELEMETRY && (LED_OUTPUT == LED_OUTPUT_USART)
+#error "LED_OUTPUT_USART occupies USART0, Serial cannot be used for telemetry"
+#endif
+
+#if !BOARD_ESP32 && ((LED_OUTPUT == LED_OUTPUT_RMT) || (LED_OUTPUT == LED_OUTPUT_I2S))
+#error "LED_OUTPUT_RMT and LED_OUTPUT_I2S are only available on ESP32"
 #endif
 
 /* Global variables */
 DS3232RTC theClock;
 Energy energy;
 CRGB leds[LED_PIXELS];
-Wordclock wordclock;
+Wordclock<LED_ROWS, LED_COLUMNS, WordLayout> wordclock;
+Scheduler scheduler;
+#if BOARD_ESP32
+Scheduler controlScheduler; // time and schedule tasks, run by the control task
+#else
+Scheduler &controlScheduler = scheduler; // a single core runs all tasks
+#endif
+AnimationClock animationClock;
+PowerEstimate powerEstimate;
+SettingsStore settings;
 IRrecv irrecv(IR_RECEIVE_PIN);
+#if LED_OUTPUT == LED_OUTPUT_USART
+UsartWS2812Controller<LED_COLOR_ORDER> ledOutput;
+#endif
+#if DEBUG
+DebugLog<DEBUG_LOG_SIZE> debugLog;
+#endif
+#if DEBUG_PROFILE
+Profiler profiler;
+#endif
+#if BOARD_ESP32
+Mailbox<Frame> frames;               // render task => output task
+Frame outputFrame;                   // shown by the output task, registered with FastLED
+TaskHandle_t outputTask = NULL;
+volatile bool isOutputBusy = false;  // output task is showing a frame
+volatile bool isStripDark = false;   // render task handed over a black frame, see handleSchedule
+Mailbox<tmElements_t> timeUpdates;   // control task => render task
+tmElements_t shownTime;              // time of the time mask, taken from timeUpdates
+volatile bool isTimePending = false; // time changed, but the previous update was not taken yet
+volatile uint32_t wokeUpAt = 0;      // us, set by the control task in resumeFromSleep
+bool isResumeFrame = false;          // the next published frame is the first after waking up
+#else
+tmElements_t &shownTime = t; // time of the time mask, read directly on a single core
+#endif
 
 /* Interrupt handling */
-uint8_t interruptDeltaT = 2; // ~seconds at which timer1 should interrupt
+#ifndef IRAM_ATTR
+#define IRAM_ATTR // ESP32 only, ISRs are placed in IRAM there
+#endif
+
+void setupInterrupts();
+void pollIR();
+void idle();
+#if !BOARD_ESP32
 void setupTimer1();
 ISR(TIMER1_COMPA_vect);
-void isrAlarm();
+#endif
+void IRAM_ATTR isrAlarm();
 
 // ===================================
 // MAIN
@@ -89,37 +197,67 @@ void isrAlarm();
  */
 void setup()
 {
-  Serial.begin(9600);
-  while (!Serial)
-  {
-  }
-  DBG_PRINTLN("Setup...");
+#if DEBUG || TELEMETRY
+  Serial.begin(DEBUG_BAUD);
+#endif
+  DBG_PRINTLN(F("Setup..."));
 
   // RTC
   wordclock.initRTC(theClock);
   if (SET_TIMER)
   {
     wordclock.setRtcTime(theClock, 14, 6);
-    DBG_PRINTLN("Time set...");
+    DBG_PRINTLN(F("Time set..."));
     return; // early exit
   }
+  isTimeSynced = readTime();
+  publishTime();
+  DBG_PRINTLN(F("RTC..."));
 
-  pinMode(RTC_ALARM_PIN, INPUT_PULLUP);
-  attachInterrupt(INT0, isrAlarm, FALLING);
-  DBG_PRINTLN("RTC...");
+#if BOARD_ESP32
+  EEPROM.begin(SETTINGS_ADDRESS + (SETTINGS_SLOTS * sizeof(SettingsRecord)));
+#endif
+  restoreSettings();
 
   // LED
+#if LED_OUTPUT == LED_OUTPUT_USART
+  FastLED.addLeds(&ledOutput, leds, LED_PIXELS).setCorrection(TypicalLEDStrip);
+#elif BOARD_ESP32
+  FastLED.addLeds<LED_TYPE, LED_DATA_PIN, LED_COLOR_ORDER>(outputFrame.leds, LED_PIXELS).setCorrection(TypicalLEDStrip);
+  xTaskCreatePinnedToCore(outputLoop, "output", ESP32_TASK_STACK, NULL, 2, &outputTask, ESP32_OUTPUT_CORE); // above loop(), starts a frame right away
+#else
   FastLED.addLeds<LED_TYPE, LED_DATA_PIN, LED_COLOR_ORDER>(leds, LED_PIXELS).setCorrection(TypicalLEDStrip);
+#endif
   FastLED.setBrightness(newBrightness);
-  DBG_PRINTLN("LED...");
 
-  // IR
-  irrecv.enableIRIn();
-  DBG_PRINTLN("IR...");
+  // show the time as early as possible, everything below can wait for it
+  showFrameNow();
+  telemetry.bootMillis = millis();
+  DBG_PRINTLN(F("LED..."));
+
+#if !BOARD_ESP32
+  // RTC and IR, on ESP32 set up by the control task
+  setupInterrupts();
 
   // TIMER
   setupTimer1();
-  DBG_PRINTLN("Timer1...");
+  DBG_PRINTLN(F("Timer1..."));
+#endif
+
+  // TASKS
+  scheduler.setTask(TASK_RENDER, handleRender, 1000000UL / modeFps(ledMode));
+  scheduler.setTask(TASK_IR, handleIRresults, TASK_IR_INTERVAL);
+  controlScheduler.setTask(TASK_TIME, handleTime, TASK_TIME_INTERVAL);
+  controlScheduler.setTask(TASK_SCHEDULE, handleSchedule, TASK_SCHEDULE_INTERVAL);
+#if TELEMETRY
+  scheduler.setTask(TASK_TELEMETRY, handleTelemetry, TASK_TELEMETRY_INTERVAL);
+#endif
+  scheduler.setTask(TASK_SETTINGS, handleSettings, TASK_SETTINGS_INTERVAL);
+#if BOARD_ESP32
+  xTaskCreatePinnedToCore(controlLoop, "control", ESP32_TASK_STACK, NULL, 1, NULL, ESP32_CONTROL_CORE);
+#endif
+  DBG_PRINTLN(F("Tasks..."));
+  DBG_LOG(F("BOOT ms"), telemetry.bootMillis);
 }
 
 /**
@@ -132,437 +270,766 @@ void loop()
     return;
   }
 
-  if (isrAlarmWasCalled)
-  {
-    // ah, just woke up ...
-    theClock.alarm(DS3232RTC::ALARM_2); // reset alarm flag
-    isrAlarmWasCalled = false;
-  }
-
-  handleIRresults();
+  bool hasRun = scheduler.run();
 
-  if (!pauseAnimations)
-  {
-    // simple schedule
-    theClock.read(t);
-    if (wordclock.shouldGoToSleep(t))
-    { // leds should not be active
-      if (!isPowerOffInitialized)
-      {
+#if DEBUG_PROFILE || TELEMETRY
+  if (Serial.available())
+    handleSerialCommand(Serial.read());
+#endif
 
-        // set all leds to black/off
-        fill_solid(leds, LED_PIXELS, CRGB::Black);
-        isPowerOffInitialized = true;
-        FastLED.show();
+#if DEBUG
+  if (!hasRun)
+    debugLog.drain(Serial);
+#endif
 
-        // activate schedule
-        wordclock.setAlarmScheduleAndEnterLowPower(theClock, energy);
-      }
-    }
-    else
-    { // leds are active
-      isPowerOffInitialized = false;
-      handleLeds();
-    }
-  }
-  else if (irCtr >= IR_PAUSE)
-  {
-    pauseAnimations = false;
-  }
+#if BOARD_IDLE_SLEEP
+  if (!hasRun)
+    idle();
+#endif
+  (void)hasRun; // unused without DEBUG and BOARD_IDLE_SLEEP
 }
 
 // ===================================
 // FUNCTION IMPLEMENTATIONS
 // ===================================
 
+#if BOARD_IDLE_SLEEP
 /**
- * Setup up Timer1 to be called every second.
+ * Idle until the next interrupt, which is at most 50 us away on AVR (IRremote's
+ * Timer2 tick). Entries and idle time are counted for telemetry, timing costs
+ * two micros() calls per entry.
  */
-void setupTimer1()
+void idle()
 {
-  noInterrupts(); // stop all interrupts
-  TCCR1A = 0;
-  TCCR1B = 0;
-  TCNT1 = 0;                                               // initialize register with 0
-  OCR1A = (interruptDeltaT * BOARD_FREQ / TIMER_PRESCALE); // initialize Output Compare Register
-  TCCR1B |= (1 << WGM12);                                  // turn on CTC mode
-  TCCR1B |= (1 << CS12);                                   // 256 prescale value
-  TIMSK1 |= (1 << OCIE1A);                                 // activate Timer Compare Interrupt
-  interrupts();
+  PROFILE_BEGIN(PROFILE_IDLE);
+#if TELEMETRY
+  uint32_t idleStart = micros();
+#endif
+  wordclock.enterIdle(energy); // next timer interrupt wakes up again
+#if TELEMETRY
+  telemetry.idles++;
+  telemetry.idleMicros += micros() - idleStart;
+#endif
+  PROFILE_END(PROFILE_IDLE);
 }
+#endif
 
 /**
- * Interrupt service routine for Timer1.
- * Is triggered when TCNT1 equals OCR1A.
- * Meaning it is called when Timer1 reaches the value defined during intialization.
+ * Attach the RTC interrupt and start the IR receiver.
+ * Their interrupts are served on the core which calls this.
  */
-ISR(TIMER1_COMPA_vect)
+void setupInterrupts()
 {
-  TCNT1 = 0;                                           // (re-)initialize register with 0
-  updateTime = true;                                   // trigger time update
-  shouldEvaluateIRresults = irrecv.decode(&irResults); // check IR receiver
-  irCtr++;                                             // increase work-around counter
-}
+  pinMode(RTC_ALARM_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(RTC_ALARM_PIN), isrAlarm, FALLING);
 
-/**
- * Interrupt service routine for RTC.
- * Used to wake up the Arduino from power down state.
- * Will be called when RTC detects a matching for the activated schedule.
- */
-void isrAlarm()
-{
-  if (energy.WasSleeping())
-  {
-    /* Will only be true when Arduino was in deep sleep before calling the routine.
-       Do some re-init things when needed. */
-  }
-  isrAlarmWasCalled = true;
+  irrecv.enableIRIn();
+  DBG_PRINTLN(F("IR..."));
 }
 
 /**
- * MAIN HANDLER FUNCTIONS
+ * Queue the value of a decoded IR signal.
+ * Called by the Timer1 ISR, on ESP32 by the control task.
  */
-
-/**
- * Reset color array to black.
- */
-void clearLedColors(CRGB *leds)
+void pollIR()
 {
-  fill_solid(leds, LED_PIXELS, CRGB::Black);
-}
+  if (irrecv.decode(&irResults))
+  {
+    if (irResults.decode_type == NEC) // we just check for this protocol: NEC
+      irQueue.push(irResults.value);
+    else if (irResults.decode_type == UNKNOWN)
+      irNoiseReceived = true;
 
-/**
- * Set start of sentence
- */
-void setColorForStartOfSentence(CRGB *leds)
-{
-  wordclock.setColorForWord(leds, IT);
-  wordclock.setColorForWord(leds, IS);
+    irrecv.resume();
+  }
 }
 
+#if !BOARD_ESP32
 /**
- * Calculate the index for the five minute step.
+ * Setup up Timer1 to be called every TIMER_TICK_MS.
  */
-int getIndexForFiveMinuteStep(int minutes)
+void setupTimer1()
 {
-  if (minutes < 30)
-    return floor(t.Minute / MIN_STEP);
-
-  if (minutes > 30)
-    // -2 because: -1 in general because its an array length, -1 again because we cannot use 'half'
-    return floor((MIN_PARTS - 2) - ((t.Minute - 31) / MIN_STEP));
-
-  return 5; // index for 'half'
+  noInterrupts(); // stop all interrupts
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;                                  // initialize register with 0
+  OCR1A = TIMER_COUNTS - 1;                   // initialize Output Compare Register, counts from 0 to OCR1A
+  TCCR1B |= (1 << WGM12);                     // turn on CTC mode
+  TCCR1B |= timerClockSelect(TIMER_PRESCALE); // prescale value
+  TIMSK1 |= (1 << OCIE1A);                    // activate Timer Compare Interrupt
+  interrupts();
 }
 
 /**
- * Sets the color for the 5-Minute step.
+ * Interrupt service routine for Timer1.
+ * Is triggered when TCNT1 equals OCR1A, CTC mode then resets TCNT1.
+ * Meaning it is called every TIMER_TICK_MS.
  */
-void setColorForFiveMinuteStep(CRGB *leds, int minutes)
+ISR(TIMER1_COMPA_vect)
 {
-  if (!wordclock.shouldShowMinutes(minutes))
-    return;
-
-  // WARNING: will only be valid for mins in range of [0...55],
-  //          will cause an out-of-bounds exception for mins > 55
-  int idx = getIndexForFiveMinuteStep(minutes);
-  wordclock.setColorForWord(leds, W_MINS[idx]);
+  timerTicks++;
+#if LED_OUTPUT == LED_OUTPUT_USART
+  if (ledOutput.isSending)
+    return; // decoding takes too long while a frame is shifted out, see wordclock_output.h
+#endif
+  pollIR(); // check IR receiver
 }
+#endif
 
 /**
- * Set the color for the relation, if 'to' or 'past'.
+ * Interrupt service routine for RTC.
+ * Used to wake up the Arduino from power down state.
+ * Will be called when RTC detects a matching for the activated schedule.
  */
-void setColorForRelation(CRGB *leds, int minutes)
+void IRAM_ATTR isrAlarm()
 {
-  if (!wordclock.shouldShowMinutes(minutes))
+  if (isSquareWaveActive)
+  {
+    sqwTicks++; // falling edge of the 1 Hz square wave, a second has passed
     return;
+  }
 
-  if (minutes > 30)
-    return wordclock.setColorForWord(leds, TO); // to
-
-  return wordclock.setColorForWord(leds, PAST); // past
-}
-
-/**
- * Set the color for the current hour.
- */
-void setColorForHour(CRGB *leds, int hours, int minutes)
-{
-  int index = (minutes > 30)
-                  ? (int)ceil((t.Hour + 1) % 12) // to
-                  : (int)ceil(t.Hour % 12);      // past
-
-  wordclock.setColorForWord(leds, W_HOURS[index]);
+  telemetry.wakeUps++;
+  isrAlarmWasCalled = true; // the board continues in resumeFromSleep when it was powered down
 }
 
 /**
- * Set the color for daytime, AM or PM.
+ * MAIN HANDLER FUNCTIONS
  */
-void setColorForDaytime(CRGB *leds, int hours)
-{
-  if (hours > 12)
-    wordclock.setColorForWord(leds, PM);
-  else
-    wordclock.setColorForWord(leds, AM);
-}
 
-/**
- * Set color for the digits representing the actual minutes.
- */
-void setColorForMinuteDigits(CRGB *leds, int minutes)
+bool refreshTimeMask()
 {
-  int m1 = int(minutes / 10);        // only "first digit" of minute value, e.g. 34 => 3
-  int m2 = int(minutes - (m1 * 10)); // only "second digit" of minute value, e.g. 34 => 4
-
-  // could have an additional check if m1 == m2, but would only prevent one call
-  wordclock.setColorForDigit(leds, DIGITS[m1]);
-  wordclock.setColorForDigit(leds, DIGITS[m2]);
-}
+#if BOARD_ESP32
+  if (timeUpdates.take(shownTime))
+    updateTime = true;
+#endif
+  if (!updateTime)
+    return false;
 
-/**
- * Print a time string.
- */
-void debugTime(tmElements_t &tm)
-{
-  DBG_PRINT(tm.Hour);
-  DBG_PRINT(":");
-  DBG_PRINT(tm.Minute);
-  DBG_PRINT(":");
-  DBG_PRINT(tm.Second);
-  DBG_PRINTLN();
+  updateTime = false; // reset flag
+  DBG_LOG(F("TIME"), (shownTime.Hour * 100) + shownTime.Minute); // hhmm
+  memcpy(previousMask, timeMask, LED_MASK_BYTES);
+  wordclock.setTimeMask(timeMask, shownTime, isScheduleActive);
+  return true;
 }
 
 void handleDisplayTime()
 {
-  if (!updateTime)
-    return;
-
-  if (isTimeUpdateRunning)
-    return;
-
-  updateTime = false;         // reset flag
-  isTimeUpdateRunning = true; // prevent unecessary execution
-
-  // get time values
-  theClock.read(t);
-  debugTime(t);
+  bool isRefreshed = refreshTimeMask();
+  if (isRefreshed && (memcmp(previousMask, timeMask, LED_MASK_BYTES) != 0))
+  {
+#if LED_CROSSFADE_FRAMES > 0
+    crossfadeFrame = LED_CROSSFADE_FRAMES;
+#endif
+    if (autoCycleHue)
+      hue += LED_AUTO_HUE_STEP; // recolored with the new time, a running hue would show every frame
+  }
 
   // set colors
-  clearLedColors(leds);
-  setColorForStartOfSentence(leds);
-  setColorForFiveMinuteStep(leds, t.Minute);
-  setColorForRelation(leds, t.Minute);
-  setColorForHour(leds, t.Hour, t.Minute);
-  setColorForDaytime(leds, t.Hour);
-  setColorForMinuteDigits(leds, t.Minute);
+  if (isRefreshed || (maskHue != hue))
+  {
+    maskHue = hue;
+    wordclock.setColorForMask(leds, timeMask);
+  }
+  else if (crossfadeFrame == 0)
+  {
+    return; // nothing changed
+  }
 
-  isTimeUpdateRunning = false; // reset flag
+#if LED_CROSSFADE_FRAMES > 0
+  if (crossfadeFrame > 0)
+  {
+    uint8_t level = (255 * (LED_CROSSFADE_FRAMES - crossfadeFrame + 1)) / LED_CROSSFADE_FRAMES;
+    wordclock.crossfadeMask(leds, previousMask, timeMask, level);
+    crossfadeFrame--;
+  }
+#endif
 }
 
 void handleIRresults()
 {
-  if (!shouldEvaluateIRresults)
-  {
-    DBG_PRINTLN("no ir result to check");
-    return;
-  }
-  if (evaluatingIRresults)
-  {
-    DBG_PRINTLN("still evaluating ir result");
-    return;
-  }
+  PROFILE_BEGIN(PROFILE_IR);
 
   // work-around
-  if (irResults.decode_type == UNKNOWN)
+  if (irNoiseReceived)
   {
-    // we stop animations for X timer interrupts, so we have no blocking
+    irNoiseReceived = false;
+    telemetry.irUnknown++; // at most one per run
+#if LED_OUTPUT == LED_OUTPUT_CLOCKLESS
+    // we stop animations for IR_PAUSE ms, so we have no blocking
     // through disabled interrupts because of led updates
-    irCtr = 0;
+    irPausedAt = getTicks();
     pauseAnimations = true;
-
-    delay(50);
-    irrecv.resume();
+#endif
   }
 
-  // we just check for this protocol: NEC
-  if (irResults.decode_type != NEC)
-    return;
+  int16_t brightnessDelta = 0;
+  int16_t hueDelta = 0;
 
-  // we have a result with expected prototcol, we can enable animations again
-  pauseAnimations = false;
-  shouldEvaluateIRresults = false;
-  evaluatingIRresults = true;
+  bool isHandled = false;
+  uint32_t result;
+  while (irQueue.pop(result))
+  {
+    telemetry.irReceived++;
+    isHandled = true;
 
-  evaluateIRResult(irResults.value);
+    // we have a result with expected prototcol, we can enable animations again
+    pauseAnimations = false;
 
-  delay(50);
-  irrecv.resume();
-  evaluatingIRresults = false;
-}
+    if (result == IR_REPEAT)
+    { // key is still held
+      if (irHoldCount < 255)
+        irHoldCount++;
+    }
+    else
+    {
+      irLastKey = (result & 0xffff); // for the 'why?' see init section for IR_*
+      irHoldCount = 0;
+    }
 
-void evaluateIRResult(uint32_t result)
-{
-  DBG_PRINTLN(result, HEX);
+    // the longer a key is held the bigger the steps get
+    uint8_t factor = min(1 + (irHoldCount / IR_HOLD_ACCELERATION), IR_HOLD_FACTOR_MAX);
+    if (accumulateIRAdjustment(irLastKey, factor, brightnessDelta, hueDelta))
+      continue;
 
-  uint16_t valueToCheck = (result & 0xffff); // for the 'why?' see init section for IR_*
+    if (result != IR_REPEAT)
+      evaluateIRResult(result);
+  }
 
-  switch (valueToCheck)
+  // apply all adjustments of this batch at once
+  if (brightnessDelta != 0)
+    wordclock.increaseBrightness(brightnessDelta);
+  if (hueDelta != 0)
+    wordclock.increaseHue(hueDelta);
+  if (isHandled)
+    settings.touch(); // saved once no key was pressed for a while
+
+  PROFILE_END(PROFILE_IR);
+}
+
+bool accumulateIRAdjustment(uint16_t key, uint8_t factor, int16_t &brightnessDelta, int16_t &hueDelta)
+{
+  switch (key)
   {
-  // animations
-  case IR_ZERO:
-    setLEDModeState(">>NORMAL", LED_MODE_NORMAL, 25);
-    break;
-  case IR_ONE:
-    setLEDModeState(">>RAINBOW", LED_MODE_RAINBOW, 60);
-    break;
-  case IR_TWO:
-    setLEDModeState(">>RAINBOW GLITTER", LED_MODE_RAINBOW_GLITTER, 60);
-    break;
-  case IR_THREE:
-    setLEDModeState(">>CONFETTI", LED_MODE_CONFETTI, 60);
-    break;
-  case IR_FOUR:
-    setLEDModeState(">>SINELON", LED_MODE_SINELON, 60);
-    break;
-  case IR_FIVE:
-    setLEDModeState(">>BPM", LED_MODE_BPM, 60);
-    break;
-  case IR_SIX:
-    setLEDModeState(">>JUGGLE", LED_MODE_JUGGLE, 60);
-    break;
-  case IR_SEVEN:
-    setLEDModeState(">>MATRIX", LED_MODE_MATRIX, 25);
-    break;
   // brightness
   case IR_VOL_UP:
-    DBG_PRINTLN("BRIGHTNESS++");
-    wordclock.increaseBrightness(LED_BRIGHTNESS_STEP);
-    break;
+    DBG_LOG(F("BRIGHTNESS++"), factor);
+    brightnessDelta += LED_BRIGHTNESS_STEP * factor;
+    return true;
   case IR_VOL_DOWN:
-    DBG_PRINTLN("BRIGHTNESS--");
-    wordclock.increaseBrightness(LED_BRIGHTNESS_STEP * -1);
-    break;
+    DBG_LOG(F("BRIGHTNESS--"), factor);
+    brightnessDelta -= LED_BRIGHTNESS_STEP * factor;
+    return true;
   // hue
   case IR_UP:
-    DBG_PRINTLN("HUE++");
-    wordclock.increaseHue(LED_HUE_STEP);
-    break;
+    DBG_LOG(F("HUE++"), factor);
+    hueDelta += LED_HUE_STEP * factor;
+    return true;
   case IR_DOWN:
-    DBG_PRINTLN("HUE--");
-    wordclock.increaseHue(LED_HUE_STEP * -1);
-    break;
+    DBG_LOG(F("HUE--"), factor);
+    hueDelta -= LED_HUE_STEP * factor;
+    return true;
+  }
+  return false;
+}
+
+void evaluateIRResult(uint32_t result)
+{
+  uint16_t valueToCheck = (result & 0xffff); // for the 'why?' see init section for IR_*
+  DBG_LOG_HEX(F("IR"), valueToCheck);
+
+  // animations
+  for (uint8_t mode = 0; mode < LED_MODE_COUNT; mode++)
+  {
+    if (modeKey(mode) == valueToCheck)
+    {
+      setLEDModeState(mode);
+      return;
+    }
+  }
+
+  switch (valueToCheck)
+  {
+  // brightness and hue, see accumulateIRAdjustment
   // schedule
   case IR_POWER:
-    DBG_PRINTLN(">>SCHEDULE");
     isScheduleActive = !isScheduleActive;
+    DBG_LOG(F(">>SCHEDULE"), isScheduleActive);
     blinkToConfirm = true;
     break;
   // automatic routines
   case IR_AUTO_HUE:
-    DBG_PRINTLN(">>AUTO HUE");
     autoCycleHue = !autoCycleHue;
+    DBG_LOG(F(">>AUTO HUE"), autoCycleHue);
     blinkToConfirm = true;
     break;
   case IR_AUTO_BRIGHTNESS:
-    DBG_PRINTLN(">>AUTO HUE");
     autoCycleBrightness = !autoCycleBrightness;
+    DBG_LOG(F(">>AUTO BRIGHTNESS"), autoCycleBrightness);
     blinkToConfirm = true;
     break;
   }
 }
 
-void setLEDModeState(String debugMsg, uint8_t mode, uint8_t _fps)
+void setLEDModeState(uint8_t mode)
 {
-  DBG_PRINTLN(debugMsg);
+  DBG_LOG(modeText(mode), mode);
   ledMode = mode;
-  fps = _fps;
+  updateTime = true; // redraw time when switching back to it
+  scheduler.setInterval(TASK_RENDER, 1000000UL / modeFps(mode));
+}
+
+void renderRainbow()
+{
+  wordclock.rainbow(leds);
+}
+
+void renderRainbowWithGlitter()
+{
+  wordclock.rainbowWithGlitter(leds);
+}
+
+void renderConfetti()
+{
+  wordclock.confetti(leds);
+}
+
+void renderSinelon()
+{
+  wordclock.sinelon(leds);
+}
+
+void renderBpm()
+{
+  wordclock.bpm(leds);
+}
+
+void renderJuggle()
+{
+  wordclock.juggle(leds);
+}
+
+void renderMatrix()
+{
+  wordclock.matrix(leds);
 }
 
 void handleLeds()
 {
-  switch (ledMode)
+  animationClock.tick();
+  telemetry.frames++;
+
+  PROFILE_BEGIN(PROFILE_KERNEL);
+  modeRender(ledMode)();
+
+  if (!hasModeFlag(ledMode, MODE_STATIC))
   {
-  case LED_MODE_NORMAL:
-    handleDisplayTime();
-    break;
-  case LED_MODE_RAINBOW:
-    wordclock.rainbow(leds);
-    break;
-  case LED_MODE_RAINBOW_GLITTER:
-    wordclock.rainbowWithGlitter(leds);
-    break;
-  case LED_MODE_CONFETTI:
-    wordclock.confetti(leds);
-    break;
-  case LED_MODE_SINELON:
-    wordclock.sinelon(leds);
-    break;
-  case LED_MODE_BPM:
-    wordclock.bpm(leds);
-    break;
-  case LED_MODE_JUGGLE:
-    wordclock.juggle(leds);
-    break;
-  case LED_MODE_MATRIX:
-    wordclock.matrix(leds);
-    break;
+    isFrameDirty = true; // animations change with every frame
+#if LED_COMPOSITE != LED_COMPOSITE_NONE
+    refreshTimeMask();
+    wordclock.compositeMask(leds, timeMask);
+#endif
+#if LED_COMPOSITE == LED_COMPOSITE_ZERO
+    powerEstimate.rescan(leds, timeMask); // only the time is left lit
+#else
+    powerEstimate.rescan(leds); // kernels write every pixel directly, see wordclock_power.h
+#endif
   }
+  PROFILE_END(PROFILE_KERNEL);
 
+  PROFILE_BEGIN(PROFILE_OVERLAY);
   if (isScheduleActive)
     wordclock.setColorForDigit(leds, SCHEDULE);
 
   if (blinkToConfirm)
   {
     blinkToConfirm = false;
+    isConfirmShown = true;
+    confirmShownAt = millis();
     wordclock.setColorForWord(leds, CRGB::White, CHK);
   }
+  else if (isConfirmShown && (millis() - confirmShownAt >= LED_CONFIRM_DURATION))
+  {
+    isConfirmShown = false;
+    updateTime = true; // remove check mark, settings may have changed the time mask
+  }
+  PROFILE_END(PROFILE_OVERLAY);
 
   if (autoCycleBrightness)
   {
-    if (millis() % 20 == 0)
+    uint8_t steps = animationClock.step(brightnessFraction, LED_BRIGHTNESS_RATE);
+    if (incBrightness)
     {
-      if (incBrightness)
+      if (newBrightness + steps > 180)
       {
-        newBrightness++;
-        if (newBrightness > 180)
-        {
-          newBrightness = 180;
-          incBrightness = false;
-        }
+        newBrightness = 180;
+        incBrightness = false;
       }
       else
+        newBrightness += steps;
+    }
+    else
+    {
+      if (newBrightness - steps < 2) // FastLED treats brightness of 0 as if it is 255
       {
-        newBrightness--;
-        if (newBrightness < 2) // FastLED treats brightness of 0 as if it is 255
-        {
-          newBrightness = 2;
-          incBrightness = true;
-        }
+        newBrightness = 2;
+        incBrightness = true;
       }
+      else
+        newBrightness -= steps;
     }
   }
 
-  if (newBrightness != oldBrightness)
+  // limit to what the supply can deliver for the current frame
+  uint8_t brightness = powerEstimate.limitBrightness(newBrightness);
+  if (brightness != oldBrightness)
   {
-    oldBrightness = newBrightness;
-    FastLED.setBrightness(newBrightness);
+    oldBrightness = brightness;
+#if !BOARD_ESP32
+    FastLED.setBrightness(brightness); // on ESP32 handed over with the frame
+#endif
+    isFrameDirty = true;
   }
 
-  FastLED.show();            // send the 'leds' array out to the actual LED strip
-  FastLED.delay(1000 / fps); // insert a delay to keep the framerate modest
+  if (isFrameDirty)
+  {
+    PROFILE_BEGIN(PROFILE_SHOW);
+    isFrameDirty = !showLeds(); // retried with the next frame while the output is busy
+    PROFILE_END(PROFILE_SHOW);
+  }
 
   // cycle through hue for some animations
-  if ((ledMode == LED_MODE_RAINBOW) || (ledMode == LED_MODE_RAINBOW_GLITTER) || (ledMode == LED_MODE_SINELON) || (ledMode == LED_MODE_JUGGLE) || autoCycleHue)
-    if (millis() % 20 == 0)
+  if (hasModeFlag(ledMode, MODE_CYCLE_HUE))
+    hue += animationClock.step(hueFraction, LED_HUE_RATE);
+  else if (autoCycleHue && !hasModeFlag(ledMode, MODE_STATIC))
+    hue += animationClock.step(hueFraction, LED_AUTO_HUE_RATE); // static modes step in handleDisplayTime
+}
+
+void handleRender()
+{
+  if (pauseAnimations)
+  {
+    if (getTicks() - irPausedAt >= MS_TO_TICKS(IR_PAUSE))
+      pauseAnimations = false;
+    return;
+  }
+
+  if (isPowerOffInitialized)
+  {
+#if BOARD_ESP32
+    refreshTimeMask(); // keep taking time updates while dark
+    if (!isStripDark)
+    { // the control task waits for this frame before the board sleeps
+      fill_solid(leds, LED_PIXELS, CRGB::Black);
+      powerEstimate.clear();
+      isStripDark = showLeds();
+    }
+#endif
+    return; // leds should not be active
+  }
+
+#if BOARD_ESP32
+  if (isStripDark)
+  { // woke up, see resumeFromSleep
+    isStripDark = false;
+    isResumeFrame = true; // timed by the output task
+    showFrameNow();
+    return;
+  }
+#endif
+
+  handleLeds();
+}
+
+bool showLeds()
+{
+#if BOARD_ESP32
+  Frame *frame = frames.claim();
+  if (frame == NULL)
+    return false; // output task did not take the previous frame yet
+
+  memcpy(frame->leds, leds, sizeof(leds));
+  frame->brightness = oldBrightness;
+  frame->isResume = isResumeFrame;
+  isResumeFrame = false;
+  frames.publish();
+  xTaskNotifyGive(outputTask);
+#elif LED_OUTPUT == LED_OUTPUT_USART
+  FastLED.show();
+  if (ledOutput.takeUnderrun())
+    return false; // the pixels may have latched within the frame, send it again
+#else
+  FastLED.show(); // send the 'leds' array out to the actual LED strip
+#endif
+  return true;
+}
+
+bool readTime()
+{
+  PROFILE_BEGIN(PROFILE_RTC);
+  telemetry.rtcReads++;
+  bool isRead = (theClock.read(t) == 0);
+  if (!isRead)
+    telemetry.rtcErrors++; // t is unchanged
+  PROFILE_END(PROFILE_RTC);
+  return isRead;
+}
+
+void handleTime()
+{
+  uint8_t lastMinute = t.Minute;
+
+#if RTC_SQW_CLOCK
+  uint8_t ticks = sqwTicks; // only written by isrAlarm, a single byte is read atomically
+  uint8_t seconds = ticks - sqwTicksSeen;
+  sqwTicksSeen = ticks;
+
+  bool hasHourPassed = wordclock.advanceTime(t, seconds); // also while not synced, a failed read only misses its correction
+  if (!isTimeSynced || hasHourPassed)
+    isTimeSynced = readTime(); // full read at boot and once an hour, retried with the next run on errors
+#else
+  readTime();
+#endif
+
+#if BOARD_ESP32
+  if (isTimePending)
+    publishTime();
+#endif
+  if (t.Minute != lastMinute)
+    publishTime();
+}
+
+void publishTime()
+{
+#if BOARD_ESP32
+  isTimePending = !timeUpdates.put(t); // the render task must not read t while it is written
+#else
+  updateTime = true;
+#endif
+}
+
+void handleSchedule()
+{
+  if (isrAlarmWasCalled)
+  {
+    // ah, just woke up ...
+    theClock.alarm(DS3232RTC::ALARM_2); // reset alarm flag
+    isrAlarmWasCalled = false;
+
+#if RTC_SQW_CLOCK
+    wordclock.enableSquareWave(theClock);
+    isTimeSynced = false; // seconds were not counted while sleeping
+#endif
+    publishTime();
+  }
+
+  if (pauseAnimations)
+    return;
+
+  if (!wordclock.shouldGoToSleep(t))
+  { // leds are active
+    isPowerOffInitialized = false;
+    return;
+  }
+
+#if BOARD_ESP32
+  // the render task owns the leds, it hands over a black frame first (handleRender)
+  isPowerOffInitialized = true;
+  if (!isStripDark || !frames.isEmpty() || isOutputBusy)
+    return; // not shown yet, sleep with one of the next runs
+#else
+  if (isPowerOffInitialized)
+    return;
+
+  // set all leds to black/off
+  fill_solid(leds, LED_PIXELS, CRGB::Black);
+  powerEstimate.clear();
+  isPowerOffInitialized = true;
+  FastLED.show();
+#endif
+
+  // activate schedule
+  telemetry.sleeps++;
+  wordclock.setAlarmScheduleAndEnterLowPower(theClock, t, energy);
+  resumeFromSleep();
+}
+
+void showFrameNow()
+{
+  // no crossfade from whatever was shown before
+  updateTime = true;
+  refreshTimeMask();
+  memcpy(previousMask, timeMask, LED_MASK_BYTES);
+  crossfadeFrame = 0;
+  if (ledMode == LED_MODE_NORMAL)
+  {
+    maskHue = hue;
+    wordclock.setColorForMask(leds, timeMask);
+  }
+  handleLeds();
+}
+
+void resumeFromSleep()
+{
+#if !BOARD_ESP32
+  uint32_t wokeUpAt = micros();
+#else
+  wokeUpAt = micros();
+#endif
+
+  theClock.alarm(DS3232RTC::ALARM_2); // reset alarm flag
+  isrAlarmWasCalled = false;
+#if RTC_SQW_CLOCK
+  wordclock.enableSquareWave(theClock);
+#endif
+  isTimeSynced = readTime(); // seconds were not counted while sleeping
+  publishTime();
+  isPowerOffInitialized = false;
+#if !BOARD_ESP32
+  showFrameNow();
+
+  recordResume(wokeUpAt);
+  DBG_LOG(F("RESUME us"), telemetry.resumeMicros);
+#endif // on ESP32 the render task shows the frame, the output task records it
+}
+
+/**
+ * Time from waking up to the first shown frame, saturates at 65.535 ms.
+ */
+void recordResume(uint32_t since)
+{
+  uint32_t elapsed = micros() - since;
+  telemetry.resumeMicros = (elapsed > 0xFFFF) ? 0xFFFF : elapsed;
+}
+
+void restoreSettings()
+{
+  SettingsRecord record;
+  if (!settings.load(record))
+    return;
+
+  if (record.ledMode < LED_MODE_COUNT)
+    ledMode = record.ledMode;
+  hue = record.hue;
+  newBrightness = record.brightness;
+  isScheduleActive = record.flags & SETTINGS_FLAG_SCHEDULE;
+  autoCycleHue = record.flags & SETTINGS_FLAG_AUTO_HUE;
+  autoCycleBrightness = record.flags & SETTINGS_FLAG_AUTO_BRIGHTNESS;
+}
+
+void handleSettings()
+{
+  settings.run();
+  if (!settings.isDue())
+    return;
+
+  SettingsRecord record;
+  record.ledMode = ledMode;
+  record.hue = hue;
+  record.brightness = newBrightness;
+  record.flags = (isScheduleActive ? SETTINGS_FLAG_SCHEDULE : 0) |
+                 (autoCycleHue ? SETTINGS_FLAG_AUTO_HUE : 0) |
+                 (autoCycleBrightness ? SETTINGS_FLAG_AUTO_BRIGHTNESS : 0);
+  settings.save(record);
+}
+
+void handleTelemetry()
+{
+  uint32_t now = micros();
+  uint32_t elapsed = now - telemetrySentAt;
+  uint8_t achievedFps = (elapsed > 0) ? (((uint32_t)telemetry.frames * 1000000UL) + (elapsed / 2)) / elapsed : 0;
+
+  noInterrupts();
+  uint16_t wakeUps = telemetry.wakeUps;
+  interrupts();
+
+  uint8_t flags = (isScheduleActive << 0) | (autoCycleHue << 1) | (autoCycleBrightness << 2) |
+                  (pauseAnimations << 3) | (isPowerOffInitialized << 4) | (isTimeSynced << 5);
+
+  TelemetryFrame frame;
+  frame.put32(millis());
+  frame.put8(ledMode);
+  frame.put8(modeFps(ledMode)); // target
+  frame.put8(achievedFps);
+  frame.put8(newBrightness);
+  frame.put8(hue);
+  frame.put8(flags);
+  frame.put16(telemetry.irReceived);
+  frame.put8(irQueue.getDropped());
+  frame.put16(telemetry.irUnknown);
+  frame.put16(telemetry.rtcReads);
+  frame.put16(telemetry.rtcErrors);
+  frame.put16(telemetry.sleeps);
+  frame.put16(wakeUps);
+  frame.put16(telemetry.resumeMicros);
+  frame.put16(telemetry.bootMillis);
+  frame.put32(telemetry.idles);
+  frame.put32(telemetry.idleMicros);
+
+  if (!frame.send(Serial))
+    return; // TX buffer busy, frames keep counting until the next run
+
+  telemetry.frames = 0;
+  telemetry.idles = 0;
+  telemetry.idleMicros = 0;
+  telemetrySentAt = now;
+}
+
+void handleSerialCommand(int command)
+{
+  switch (command)
+  {
+#if TELEMETRY
+  case TELEMETRY_REQUEST:
+    handleTelemetry();
+    break;
+#endif
+#if DEBUG_PROFILE
+  case 'p':
+    profiler.dump(Serial);
+    profiler.reset();
+    break;
+#endif
+  }
+}
+
+#if BOARD_ESP32
+void controlLoop(void *parameters)
+{
+  setupInterrupts(); // served on this core from now on
+
+  for (;;)
+  {
+    pollIR();
+    if (!controlScheduler.run())
+      wordclock.enterIdle(energy);
+  }
+}
+
+void outputLoop(void *parameters)
+{
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // woken up by showLeds
+    isOutputBusy = true;                     // before the mailbox is released, see handleSchedule
+    if (frames.take(outputFrame))
     {
-      hue++;
+      FastLED.setBrightness(outputFrame.brightness);
+      FastLED.show(); // RMT/I2S shift it out, loop() renders the next frame meanwhile
+      if (outputFrame.isResume)
+        recordResume(wokeUpAt); // shown, not only handed over
     }
+    isOutputBusy = false;
+  }
 }
+#endif
 
 /**
  * Init RTC module.
  */
-void Wordclock::initRTC(DS3232RTC &theClock)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::initRTC(DS3232RTC &theClock)
 {
   theClock.begin();
   theClock.setAlarm(DS3232RTC::ALM1_MATCH_DATE, 0, 0, 0, 1);
@@ -572,18 +1039,63 @@ void Wordclock::initRTC(DS3232RTC &theClock)
   theClock.alarmInterrupt(DS3232RTC::ALARM_1, false);
   theClock.alarmInterrupt(DS3232RTC::ALARM_2, false);
   theClock.squareWave(DS3232RTC::SQWAVE_NONE);
+
+#if RTC_SQW_CLOCK
+  this->enableSquareWave(theClock);
+#endif
+}
+
+/**
+ * Let the RTC output 1 Hz on its INT/SQW pin.
+ * Alarms cannot trigger interrupts meanwhile.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::enableSquareWave(DS3232RTC &theClock)
+{
+  sqwTicksSeen = sqwTicks; // count from now on
+  isSquareWaveActive = true;
+  theClock.squareWave(DS3232RTC::SQWAVE_1_HZ);
+}
+
+/**
+ * Count the given seconds on top of the last time read.
+ * Minutes, hours and day of week are carried here, so the time stays valid
+ * when the RTC cannot be read. Day and month are left to the RTC.
+ * Returns true when an hour has passed, time should be corrected from the RTC then.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+bool Wordclock<Rows, Cols, Layout>::advanceTime(tmElements_t &tm, uint8_t seconds)
+{
+  tm.Second += seconds;
+  if (tm.Second < 60)
+    return false;
+
+  tm.Minute += tm.Second / 60;
+  tm.Second %= 60;
+  if (tm.Minute < 60)
+    return false;
+
+  tm.Minute -= 60; // at most 255 seconds were added, a single hour at most
+  if (++tm.Hour >= 24)
+  {
+    tm.Hour = 0;
+    tm.Wday = (tm.Wday % 7) + 1; // 1 = Sunday
+  }
+  return true;
 }
 
 /**
  * Set RTC to a predefined time.
  */
-void Wordclock::setRtcTime(DS3232RTC &theClock, int hours, int min)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setRtcTime(DS3232RTC &theClock, int hours, int min, int wday)
 {
   tmElements_t tm;
 
   // set the RTC time
   tm.Hour = hours;
   tm.Minute = min;
+  tm.Wday = wday; // 1 = Sunday, needed by the schedule
 
   // set some defaults
   tm.Second = 0;
@@ -595,41 +1107,60 @@ void Wordclock::setRtcTime(DS3232RTC &theClock, int hours, int min)
 }
 
 /**
- * Determine if minutes should be displayed.
- * This is not necessary if minutes are 0.
- * Or, in range of 55 to 60, as the clock shows "future" 5-minute-steps.
+ * Determine if minutes should be displayed, see showsMinutes().
  */
-bool Wordclock::shouldShowMinutes(int mins)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+bool Wordclock<Rows, Cols, Layout>::shouldShowMinutes(int mins)
 {
-  return ((mins < 56) || (mins == 0));
+  return showsMinutes(mins);
 }
 
 /**
  * Check if schedule should be applied.
  */
-bool Wordclock::shouldGoToSleep(tmElements_t &tm)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+bool Wordclock<Rows, Cols, Layout>::shouldGoToSleep(tmElements_t &tm)
 {
   if (!isScheduleActive)
   {
     return false;
   }
 
-  return ((RTC_ALIVE_FROM > tm.Hour && RTC_ALIVE_FROM_MIN > tm.Minute) ||
-          (tm.Hour >= RTC_ALIVE_TO && tm.Minute >= RTC_ALIVE_TO_MIN));
+  return !isAliveAt(minuteOfWeek(tm.Wday, tm.Hour, tm.Minute));
+}
+
+/**
+ * Compute the pixel mask of the sentence for the given time.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setTimeMask(uint8_t *mask, tmElements_t &tm, bool withSchedule)
+{
+  ::setTimeMask<Layout>(mask, tm.Hour, tm.Minute, withSchedule);
 }
 
 /**
- * (Re)set the alarm schedule.
+ * (Re)set the alarm schedule to wake up with the next alive window after tm.
  */
-void Wordclock::setAlarmSchedule(DS3232RTC &theClock)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setAlarmSchedule(DS3232RTC &theClock, tmElements_t &tm)
 {
-  // set Alarm 2
-  theClock.setAlarm(DS3232RTC::ALM2_MATCH_HOURS, 0, RTC_WAKE_UP_MINS, RTC_WAKE_UP_HRS, 0);
+  uint16_t now = minuteOfWeek(tm.Wday, tm.Hour, tm.Minute);
+  uint16_t wakeUp = nextAliveMinute(now);
+  uint16_t time = wakeUp % MINUTES_PER_DAY;
+  uint16_t distance = (wakeUp + MINUTES_PER_WEEK - now) % MINUTES_PER_WEEK;
+  bool isWdayValid = (tm.Wday >= 1) && (tm.Wday <= 7); // the day of week register may never have been set
+
+  // set Alarm 2, within a day the time alone is enough and does not depend on the day of week register
+  if (((distance > 0) && (distance < MINUTES_PER_DAY)) || !isWdayValid)
+    theClock.setAlarm(DS3232RTC::ALM2_MATCH_HOURS, 0, time % 60, time / 60, 0); // without a valid day: wake up daily, the schedule is checked then
+  else
+    theClock.setAlarm(DS3232RTC::ALM2_MATCH_DAY, 0, time % 60, time / 60, (wakeUp / MINUTES_PER_DAY) + 1); // sleep through a longer off period
   // clear the alarm flags
   theClock.alarm(DS3232RTC::ALARM_1);
   theClock.alarm(DS3232RTC::ALARM_2);
   // configure the INT/SQW pin for "interrupt" operation (disable square wave output)
   theClock.squareWave(DS3232RTC::SQWAVE_NONE);
+  isSquareWaveActive = false; // only once stopped, an edge during the write is still a second
   // enable interrupt output for Alarm 2 only
   theClock.alarmInterrupt(DS3232RTC::ALARM_1, false);
   theClock.alarmInterrupt(DS3232RTC::ALARM_2, true);
@@ -639,9 +1170,10 @@ void Wordclock::setAlarmSchedule(DS3232RTC &theClock)
  * Set alarm schedule and immediately go
  * into power down state.
  */
-void Wordclock::setAlarmScheduleAndEnterLowPower(DS3232RTC &theClock, Energy &energy)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setAlarmScheduleAndEnterLowPower(DS3232RTC &theClock, tmElements_t &tm, Energy &energy)
 {
-  this->setAlarmSchedule(theClock);
+  this->setAlarmSchedule(theClock, tm);
   this->enterLowPower(energy);
 }
 
@@ -650,18 +1182,31 @@ void Wordclock::setAlarmScheduleAndEnterLowPower(DS3232RTC &theClock, Energy &en
  * Arduino will only wake up again through
  * interrupt from external module.
  */
-void Wordclock::enterLowPower(Energy &energy)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::enterLowPower(Energy &energy)
 {
   energy.PowerDown();
 }
 
+/**
+ * Enter idle mode.
+ * Timers, UART and external interrupts keep running,
+ * so millis(), IR decoding and the RTC interrupt wake the Arduino up again.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::enterIdle(Energy &energy)
+{
+  energy.Idle();
+}
+
 /**
  * Increase pixel brightness.
- * Value range is [0 ... 80].
- * 100 is not an option to save LED lifetime.
+ * Value range is [0 ... 200], the full 255 is not an option to save LED lifetime.
+ * The brightness sent to the strip may be lower, see PowerEstimate::limitBrightness.
  * For decreasing use negative step size.
  */
-void Wordclock::increaseBrightness(int stepSize)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::increaseBrightness(int stepSize)
 {
   if (newBrightness + stepSize > 200)
     newBrightness = 200;
@@ -675,7 +1220,8 @@ void Wordclock::increaseBrightness(int stepSize)
  * Increase base hue value.
  * For decreasing use negative step size.
  */
-void Wordclock::increaseHue(int stepSize)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::increaseHue(int stepSize)
 {
   /*
   FastLED uses range [0...255] to represent
@@ -688,57 +1234,137 @@ void Wordclock::increaseHue(int stepSize)
 /**
  * Color pixels for given word.
  */
-void Wordclock::setColorForWord(CRGB *leds, Word _word)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setColorForWord(CRGB *leds, const Word &_word)
 {
-  for (int i = 0; i < _word.size; i++)
+  this->setColorForWord(leds, CHSV(hue, 255, 255), _word);
+}
+
+/**
+ * Color pixels for given word.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setColorForWord(CRGB *leds, const struct CRGB color, const Word &_word)
+{
+  size_t size = wordSize(_word);
+  for (uint8_t i = 0; i < size; i++)
+    this->setPixel(leds, wordLed(_word, i), color);
+}
+
+/**
+ * Color pixels for given digit.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setColorForDigit(CRGB *leds, const Digit &digit)
+{
+  this->setPixel(leds, digitLed(digit), CHSV(hue, 255, 255));
+}
+
+/**
+ * Color pixels set within the given mask, all others are set to black.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setColorForMask(CRGB *leds, const uint8_t *mask)
+{
+  const CRGB color = CHSV(hue, 255, 255);
+  uint8_t bits = 0;
+  for (typename Panel::Index i = 0; i < Panel::PIXELS; i++)
   {
-    int ledNo = _word.leds[i];
-    if (ledNo < LED_PIXELS)
-      leds[ledNo].setHue(hue);
+    if ((i & 7) == 0)
+      bits = mask[i >> 3];
+
+    this->setPixel(leds, i, (bits & 1) ? color : CRGB(CRGB::Black));
+    bits >>= 1;
   }
 }
 
 /**
- * Color pixels for given word.
+ * Fade the pixels which differ between two masks, leaving all others untouched.
+ * Pixels only in 'to' get the given level, pixels only in 'from' the inverse.
  */
-void Wordclock::setColorForWord(CRGB *leds, const struct CRGB color, Word _word)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::crossfadeMask(CRGB *leds, const uint8_t *from, const uint8_t *to, uint8_t level)
 {
-  for (int i = 0; i < _word.size; i++)
+  const CRGB fadeIn = CHSV(hue, 255, level);
+  const CRGB fadeOut = CHSV(hue, 255, 255 - level);
+  for (uint8_t b = 0; b < Panel::MASK_BYTES; b++)
   {
-    int ledNo = _word.leds[i];
-    if (ledNo < LED_PIXELS)
-      leds[ledNo] = color;
+    uint8_t changed = from[b] ^ to[b];
+    for (uint8_t i = 0; changed != 0; i++, changed >>= 1)
+    {
+      if (changed & 1)
+        this->setPixel(leds, (b * 8) + i, (to[b] & (1 << i)) ? fadeIn : fadeOut);
+    }
   }
 }
 
 /**
- * Color pixels for given digit.
+ * Keep the animation on the pixels of the mask, zero or dim all others.
+ * Mask bytes which are all set or all clear are handled without checking single bits.
  */
-void Wordclock::setColorForDigit(CRGB *leds, Digit digit)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::compositeMask(CRGB *leds, const uint8_t *mask)
 {
-  int ledNo = digit.led;
-  if (ledNo < LED_PIXELS)
-    leds[ledNo].setHue(hue);
+  for (uint8_t b = 0; b < Panel::MASK_BYTES; b++)
+  {
+    uint8_t bits = mask[b];
+    if (bits == 0xFF)
+      continue; // all pixels are part of the time
+
+    typename Panel::Index first = b * 8;
+    uint8_t count = (Panel::PIXELS - first < 8) ? (Panel::PIXELS - first) : 8; // last byte is only partly used
+    for (uint8_t i = 0; i < count; i++)
+    {
+      if (bits & (1 << i))
+        continue;
+
+      // gather the run of background pixels, a whole byte when bits == 0
+      uint8_t run = 1;
+      while ((i + run < count) && !(bits & (1 << (i + run))))
+        run++;
+
+#if LED_COMPOSITE == LED_COMPOSITE_DIM
+      nscale8(leds + first + i, run, LED_COMPOSITE_DIM_SCALE);
+#else
+      memset(leds + first + i, 0, run * sizeof(CRGB));
+#endif
+      i += run - 1;
+    }
+  }
 }
 
 /**
- * Fill strip with rainbow colors.
+ * Set a single pixel and mark the frame as dirty
+ * if this actually changes its color.
  */
-void Wordclock::rainbow(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::setPixel(CRGB *leds, uint16_t ledNo, const struct CRGB &color)
 {
-  fill_rainbow(leds, LED_PIXELS, hue, 7); // FastLED's built-in rainbow generator
+  if (ledNo >= Panel::PIXELS)
+    return;
+
+  if (leds[ledNo] != color)
+  {
+    powerEstimate.update(leds[ledNo], color);
+    leds[ledNo] = color;
+    isFrameDirty = true;
+  }
 }
 
-// void Wordclock::addGlitter(CRGB *leds, fract8 chanceOfGlitter)
-// {
-//   if (random8() < chanceOfGlitter)
-//     leds[random16(LED_PIXELS)] += CRGB::White;
-// }
+/**
+ * Fill strip with rainbow colors.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::rainbow(CRGB *leds)
+{
+  fill_rainbow(leds, Panel::PIXELS, hue, 7); // FastLED's built-in rainbow generator
+}
 
 /**
  * Rainbow pattern with white spots.
  */
-void Wordclock::rainbowWithGlitter(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::rainbowWithGlitter(CRGB *leds)
 {
   this->rainbow(leds);
   this->addGlitter(leds, 80);
@@ -747,85 +1373,111 @@ void Wordclock::rainbowWithGlitter(CRGB *leds)
 /**
  * Random colored speckles that blink in and fade smoothly.
  */
-void Wordclock::confetti(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::confetti(CRGB *leds)
 {
-  fadeToBlackBy(leds, LED_PIXELS, 10);
-  int pos = random16(LED_PIXELS);
+  uint8_t fade = animationClock.step(fadeFraction, LED_FADE_RATE / 2);
+  if (fade > 0) // at high frame rates a frame may not add up to a whole step
+    fadeToBlackBy(leds, Panel::PIXELS, fade);
+  int pos = random16(Panel::PIXELS);
   leds[pos] += CHSV(hue + random8(64), 200, 255);
 }
 
 /**
  * A colored dot sweeping back and forth, with fading trails
  */
-void Wordclock::sinelon(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::sinelon(CRGB *leds)
 {
-  fadeToBlackBy(leds, LED_PIXELS, 20);
-  int pos = beatsin16(13, 0, LED_PIXELS - 1);
+  uint8_t fade = animationClock.step(fadeFraction, LED_FADE_RATE);
+  if (fade > 0)
+    fadeToBlackBy(leds, Panel::PIXELS, fade);
+  int pos = beatsin16(13, 0, Panel::PIXELS - 1);
   leds[pos] += CHSV(hue, 255, 192);
 }
 
 /**
  * Colored stripes pulsing at a defined Beats-Per-Minute (BPM)
+ *
+ * PartyColors_p is read straight from flash without blending. The palette
+ * index moves by 2 per pixel, so an entry is only fetched when the index
+ * enters the next of the 16 sections, i.e. every 8th pixel.
  */
-void Wordclock::bpm(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::bpm(CRGB *leds)
 {
-  uint8_t BeatsPerMinute = 62;
-  CRGBPalette16 palette = PartyColors_p;
-  uint8_t beat = beatsin8(BeatsPerMinute, 64, 255);
-  for (int i = 0; i < LED_PIXELS; i++) // 9948
+  uint8_t beat = beatsin8(LED_BPM_BEATS, 64, 255);
+  uint8_t index = hue;
+  uint8_t brightness = beat - hue;
+  uint8_t section = (index >> 4) ^ 1; // differs from the first section, forces a fetch
+  CRGB color;
+  for (typename Panel::Index i = 0; i < Panel::PIXELS; i++)
   {
-    leds[i] = ColorFromPalette(palette, hue + (i * 2), beat - hue + (i * 10));
+    if ((index >> 4) != section)
+    {
+      section = index >> 4;
+      color = CRGB(pgm_read_dword(&PartyColors_p[section]));
+    }
+    leds[i] = color;
+    leds[i].nscale8(brightness);
+    index += 2;
+    brightness += 10;
   }
 }
 
 /**
  * Eight colored dots, weaving in and out of sync with each other.
  */
-void Wordclock::juggle(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::juggle(CRGB *leds)
 {
-  fadeToBlackBy(leds, LED_PIXELS, 20);
+  uint8_t fade = animationClock.step(fadeFraction, LED_FADE_RATE);
+  if (fade > 0)
+    fadeToBlackBy(leds, Panel::PIXELS, fade);
   byte dothue = 0;
   for (int i = 0; i < 8; i++)
   {
-    leds[beatsin16(i + 7, 0, LED_PIXELS - 1)] |= CHSV(dothue, 200, 255);
+    leds[beatsin16(i + 7, 0, Panel::PIXELS - 1)] |= CHSV(dothue, 200, 255);
     dothue += 32;
   }
 }
 
 /**
- * Let letters blink like in the in the movie 'Matrix'
- * FIXME: timing issues and new letter spawning
+ * Let letters blink like in the in the movie 'Matrix'.
+ * Every column has a single drop falling down,
+ * the frame is rendered from the drops' state only.
  */
-void Wordclock::matrix(CRGB *leds)
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::matrix(CRGB *leds)
 {
-  /*
-  We are using a strip here
-  and to make even more confusing
-  the index count alternates, like:
-     1  2  3  4
-     8  7  6  5
-     9 10 11 12 ...
-*/
-
-  fadeToBlackBy(leds, LED_PIXELS, 20);
+  LedMatrix<Panel> m(leds);
 
-  // copy existing rows to following rows to have a flow effect
-  for (int i = LED_ROWS - 2; i > 0; i--)
+  for (uint8_t col = 0; col < Cols; col++)
   {
-    for (int j = LED_COLUMNS - 1; j > 0; j--)
+    Drop &drop = drops[col];
+    drop.head += animationClock.step(drop.fraction, drop.speed * 16); // 4.4 => 8.8 rows per second
+    if ((drop.speed == 0) || ((drop.head >> 8) >= Rows + LED_MATRIX_TRAIL))
+      this->spawnDrop(drop);
+
+    int8_t headRow = drop.head >> 8;
+    for (uint8_t row = 0; row < Rows; row++)
     {
-      if (i % 2 == 0)
-      {
-        leds[(((i + 1) * LED_COLUMNS) - 1) - (j % LED_COLUMNS)] = leds[(i * LED_COLUMNS) + j];
-      }
+      int8_t dist = headRow - row;
+      if ((dist >= 0) && (dist < LED_MATRIX_TRAIL))
+        m(row, col) = CHSV(drop.hue, (dist == 0) ? 128 : 255, 255 - (dist * (255 / LED_MATRIX_TRAIL)));
       else
-      {
-        leds[((i + 1) * LED_COLUMNS) + (j % LED_COLUMNS)] = leds[(i * LED_COLUMNS) - ((j % LED_COLUMNS) + 1)];
-      }
+        m(row, col) = CRGB::Black;
     }
   }
+}
 
-  // spawn new pixels in first row
-  int pos = random16(LED_COLUMNS);
-  leds[pos] = CHSV(hue, 255, 192);
+/**
+ * Restart a drop above the first row with random delay and speed.
+ */
+template <uint8_t Rows, uint8_t Cols, typename Layout>
+void Wordclock<Rows, Cols, Layout>::spawnDrop(Drop &drop)
+{
+  drop.head = -((int16_t)random8(Rows) << 8);
+  drop.speed = random8(LED_MATRIX_SPEED_MIN, LED_MATRIX_SPEED_MAX);
+  drop.hue = hue;
 }
@@ -0,0 +1,48 @@
+#ifndef WORDCLOCK_ANIMATION_HEADER
+#define WORDCLOCK_ANIMATION_HEADER
+
+/*
+  Frame-rate independent animation clock.
+
+  tick() measures the time since the previous frame, step() converts a
+  rate in units per second into whole units for this frame. The fraction
+  left over is kept in an 8.8 fixed point accumulator per animated value,
+  so slow rates and low frame rates still add up exactly.
+*/
+
+#define ANIMATION_MAX_DELTA 250000UL // us, longer gaps (e.g. pauses) do not let animations jump
+
+class AnimationClock
+{
+public:
+  AnimationClock() : last(0), delta(0){};
+
+  /**
+   * Start a new frame.
+   */
+  void tick()
+  {
+    uint32_t now = micros();
+    uint32_t elapsed = now - last;
+    if (elapsed > ANIMATION_MAX_DELTA)
+      elapsed = ANIMATION_MAX_DELTA;
+    last = now;
+    delta = (elapsed * 1073UL) >> 14; // us => 1/65536 s, 1073 / 2^14 ~ 65536 / 10^6
+  }
+
+  /**
+   * Whole units to advance this frame for the given rate in units per second.
+   */
+  uint8_t step(uint16_t &fraction, uint16_t unitsPerSecond)
+  {
+    uint32_t units = fraction + (((uint32_t)unitsPerSecond * delta) >> 8); // 8.8 fixed point
+    fraction = units & 0xFF;
+    return (units > 0xFFFF) ? 255 : (units >> 8);
+  }
+
+private:
+  uint32_t last;  // us
+  uint16_t delta; // 1/65536 s
+};
+
+#endif
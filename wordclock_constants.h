@@ -1,10 +1,24 @@
+/*
+  All words, digits and their labels are stored in PROGMEM.
+  At runtime they have to be read through the accessors below,
+  at compile time (e.g. for the frame masks) they can be used directly.
+*/
+
 /* Macro */
-#define WORD(s, a)                     \
-    {                                  \
-        s, a, sizeof(a) / sizeof(a[0]) \
+#define LABEL(name) constexpr char T_##name[] PROGMEM = #name
+
+#define INDEXES(name, ...) \
+    LABEL(name);           \
+    constexpr LedIndex A_##name[] PROGMEM = {__VA_ARGS__}
+
+#define WORD(name)                                                  \
+    {                                                               \
+        T_##name, A_##name, sizeof(A_##name) / sizeof(A_##name[0]) \
     }
 
 /* Structs */
+typedef Geometry<LED_ROWS, LED_COLUMNS>::Index LedIndex;
+
 struct wording
 {
     /**
@@ -15,7 +29,7 @@ struct wording
     /**
      * Index array.
      */
-    const uint8_t *leds;
+    const LedIndex *leds;
 
     /**
      * Amount of LEDs used.
@@ -38,56 +52,144 @@ struct digit
 };
 typedef struct digit Digit;
 
+/* Accessors */
+inline size_t wordSize(const Word &w)
+{
+    return pgm_read_word(&w.size);
+}
+
+inline LedIndex wordLed(const Word &w, uint8_t i)
+{
+    return pgmRead((const LedIndex *)pgm_read_ptr(&w.leds) + i);
+}
+
+inline const __FlashStringHelper *wordText(const Word &w)
+{
+    return (const __FlashStringHelper *)pgm_read_ptr(&w.text);
+}
+
+inline uint16_t digitLed(const Digit &d)
+{
+    return pgm_read_word(&d.led);
+}
+
+inline const __FlashStringHelper *digitText(const Digit &d)
+{
+    return (const __FlashStringHelper *)pgm_read_ptr(&d.text);
+}
+
 /* Definitions */
-const uint8_t A_IT[] = {0, 1};
-const Word IT = WORD("IT", A_IT);
-
-const uint8_t A_IS[] = {3, 4};
-const Word IS = WORD("IS", A_IS);
-
-const uint8_t A_M5[] = {29, 30, 31, 32};
-const uint8_t A_M10[] = {21, 20, 19};
-const uint8_t A_M15[] = {7, 17, 16, 15, 14, 13, 12, 11}; // >> "a quarter"
-const uint8_t A_M20[] = {23, 24, 25, 26, 27, 28};
-const uint8_t A_M25[] = {23, 24, 25, 26, 27, 28, 29, 30, 31, 32}; // only for simplicity
-const uint8_t A_M30[] = {6, 7, 8, 9};
-const Word W_MINS[] = {
-    WORD("M5", A_M5), WORD("M10", A_M10), WORD("M15", A_M15),
-    WORD("M20", A_M20), WORD("M25", A_M25), WORD("M30", A_M30)};
-
-const uint8_t A_TO[] = {43, 42};
-const Word TO = WORD("TO", A_TO);
-
-const uint8_t A_PAST[] = {41, 40, 39, 38};
-const Word PAST = WORD("PAST", A_PAST);
-
-const uint8_t A_H12[] = {60, 59, 58, 57, 56, 55};
-const uint8_t A_H1[] = {73, 74, 75};
-const uint8_t A_H2[] = {48, 49, 50};
-const uint8_t A_H3[] = {65, 64, 63, 62, 61};
-const uint8_t A_H4[] = {36, 35, 34, 33};
-const uint8_t A_H5[] = {44, 45, 46, 47};
-const uint8_t A_H6[] = {92, 93, 94};
-const uint8_t A_H7[] = {87, 86, 85, 84, 83};
-const uint8_t A_H8[] = {81, 80, 79, 78, 77};
-const uint8_t A_H9[] = {51, 52, 53, 54};
-const uint8_t A_H10[] = {89, 90, 91};
-const uint8_t A_H11[] = {67, 68, 69, 70, 71, 72};
-const Word W_HOURS[] = {
-    WORD("H12", A_H12), WORD("H1", A_H1), WORD("H2", A_H2),
-    WORD("H3", A_H3), WORD("H4", A_H4), WORD("H5", A_H5),
-    WORD("H6", A_H6), WORD("H7", A_H7), WORD("H8", A_H8),
-    WORD("H9", A_H9), WORD("H10", A_H10), WORD("H11", A_H11)};
-
-const uint8_t A_AM[] = {107, 106};
-const Word AM = WORD("AM", A_AM);
-
-const uint8_t A_PM[] = {102, 101};
-const Word PM = WORD("PM", A_PM);
-
-const Digit SCHEDULE = {"S", 110}; // pseudo-digit
-const Digit DIGITS[] = {
-    {"D0", 111}, {"D1", 112}, {"D2", 113}, {"D3", 114}, {"D4", 115}, {"D5", 116}, {"D6", 117}, {"D7", 118}, {"D8", 119}, {"D9", 120}};
-
-const uint8_t A_CHK[] = {64, 68, 84, 92, 82, 72, 58, 52, 34};
-const Word CHK = WORD("CHK", A_CHK);
\ No newline at end of file
+#include LED_LAYOUT
+
+/* Frame masks */
+struct frameMask
+{
+    uint8_t bytes[LED_MASK_BYTES];
+};
+typedef struct frameMask FrameMask;
+
+/**
+ * Bits of the given word which fall into byte b of a pixel mask.
+ */
+constexpr uint8_t maskByteOf(const Word &w, uint8_t b, size_t i = 0)
+{
+    return (i >= w.size)
+               ? 0
+               : ((((w.leds[i] >> 3) == b) ? (1 << (w.leds[i] & 7)) : 0) | maskByteOf(w, b, i + 1));
+}
+
+constexpr uint8_t maskByte(uint8_t)
+{
+    return 0;
+}
+
+/**
+ * Bits of all given words which fall into byte b of a pixel mask.
+ */
+template <typename... Words>
+constexpr uint8_t maskByte(uint8_t b, const Word &w, const Words &... rest)
+{
+    return maskByteOf(w, b) | maskByte(b, rest...);
+}
+
+/**
+ * Mask of all given words, one maskByte() per byte of the mask.
+ */
+template <uint16_t... Bs, typename... Words>
+constexpr FrameMask maskOf(Indices<Bs...>, const Words &... words)
+{
+    return {{maskByte(Bs, words...)...}};
+}
+
+#define MASK(...) maskOf(MakeIndices<LED_MASK_BYTES>::type(), __VA_ARGS__)
+
+/**
+ * Start of sentence, five-minute step and relation.
+ * Indexed by the frame step of the current minutes.
+ */
+constexpr FrameMask FRAME_MINS[MIN_FRAMES] PROGMEM = {
+    MASK(IT, IS, W_MINS[0], PAST), // :00 - :04
+    MASK(IT, IS, W_MINS[1], PAST), // :05 - :09
+    MASK(IT, IS, W_MINS[2], PAST), // :10 - :14
+    MASK(IT, IS, W_MINS[3], PAST), // :15 - :19
+    MASK(IT, IS, W_MINS[4], PAST), // :20 - :24
+    MASK(IT, IS, W_MINS[5], PAST), // :25 - :30
+    MASK(IT, IS, W_MINS[4], TO),   // :31 - :35
+    MASK(IT, IS, W_MINS[3], TO),   // :36 - :40
+    MASK(IT, IS, W_MINS[2], TO),   // :41 - :45
+    MASK(IT, IS, W_MINS[1], TO),   // :46 - :50
+    MASK(IT, IS, W_MINS[0], TO),   // :51 - :55
+    MASK(IT, IS)};                 // :56 - :59
+
+/**
+ * Hours, indexed like W_HOURS.
+ */
+constexpr FrameMask FRAME_HOURS[12] PROGMEM = {
+    MASK(W_HOURS[0]), MASK(W_HOURS[1]), MASK(W_HOURS[2]),
+    MASK(W_HOURS[3]), MASK(W_HOURS[4]), MASK(W_HOURS[5]),
+    MASK(W_HOURS[6]), MASK(W_HOURS[7]), MASK(W_HOURS[8]),
+    MASK(W_HOURS[9]), MASK(W_HOURS[10]), MASK(W_HOURS[11])};
+
+/**
+ * Daytime, AM first then PM.
+ */
+constexpr FrameMask FRAME_DAYTIME[2] PROGMEM = {MASK(AM), MASK(PM)};
+
+/* Layout */
+/**
+ * Tables of the included LED_LAYOUT, the Layout of Wordclock.
+ */
+struct WordLayout
+{
+    typedef Geometry<LED_ROWS, LED_COLUMNS> Grid;
+
+    static const uint8_t *frameMins(uint8_t step)
+    {
+        return FRAME_MINS[step].bytes;
+    }
+
+    static const uint8_t *frameHours(uint8_t hours)
+    {
+        return FRAME_HOURS[hours].bytes;
+    }
+
+    static const uint8_t *frameDaytime(bool isPM)
+    {
+        return FRAME_DAYTIME[isPM ? 1 : 0].bytes;
+    }
+
+    static const Digit &digit(uint8_t i)
+    {
+        return DIGITS[i];
+    }
+
+    static const Digit &schedule()
+    {
+        return SCHEDULE;
+    }
+
+    static const Word &check()
+    {
+        return CHK;
+    }
+};
@@ -1,15 +1,44 @@
-#define TIMER_PRESCALE 256
-#define BOARD_FREQ 16000000 // 16 MHz
+#if defined(ARDUINO_ARCH_ESP32)
+#define BOARD_ESP32 1 // dual core, see wordclock_esp32.h
+#else
+#define BOARD_ESP32 0 // Arduino Nano
+#endif
+
+#define TIMER_TICK_MS 10     // Timer1 tick period, prescaler is chosen in wordclock_timer.h
+#define BOARD_FREQ 16000000UL // 16 MHz
+#ifndef BOARD_IDLE_SLEEP // may be set by the build, e.g. test/host
+#define BOARD_IDLE_SLEEP 0  // idle the MCU while no task is due, off until its saving on the board current is measured
+#endif
+
+#define ESP32_OUTPUT_CORE 1   // output task, next to loop() which renders the frames
+#define ESP32_CONTROL_CORE 0  // control task: IR decoding, time and schedule tasks
+#define ESP32_TASK_STACK 4096 // bytes per task
+
+#define LED_OUTPUT_CLOCKLESS 0 // FastLED's bit-banging driver, interrupts are disabled while updating the strip
+#define LED_OUTPUT_USART 1     // USART0 in SPI mode, data on TXD (D1), see wordclock_output.h
+#define LED_OUTPUT_RMT 2       // ESP32: FastLED's RMT driver, the peripheral shifts out the strip
+#define LED_OUTPUT_I2S 3       // ESP32: FastLED's I2S driver, the strip is shifted out by DMA
+#ifndef LED_OUTPUT // may be set by the build, e.g. test/host
+#if BOARD_ESP32
+#define LED_OUTPUT LED_OUTPUT_RMT
+#else
+#define LED_OUTPUT LED_OUTPUT_CLOCKLESS
+#endif
+#endif
 
 #define LED_DATA_PIN 4
-#define LED_PIXELS 121 // amount of pixels
-#define LED_ROWS 11    // needed for matrix-depended effects
-#define LED_COLUMNS 11 // needed for matrix-depended effects
+#ifndef LED_LAYOUT // may be set by the build together with the size, e.g. test/host
+#define LED_ROWS 11                     // rows of the face, LED_LAYOUT has to match
+#define LED_COLUMNS 11                  // columns of the face, LED_LAYOUT has to match
+#define LED_LAYOUT "wordclock_layout.h" // word tables generated by tools/layout.py
+#endif
+#define LED_PIXELS (LED_ROWS * LED_COLUMNS)
 #define LED_TYPE WS2812B
 #define LED_COLOR_ORDER GRB
+#define LED_MASK_BYTES ((LED_PIXELS + 7) / 8) // one bit per pixel
 // #define FRAMES_PER_SECOND 60
 
-#define LED_MODE_NORMAL 0
+#define LED_MODE_NORMAL 0 // index into LED_MODES (wordclock_modes.h), kept in the saved settings
 #define LED_MODE_RAINBOW 1
 #define LED_MODE_RAINBOW_GLITTER 2
 #define LED_MODE_CONFETTI 3
@@ -20,19 +49,69 @@
 #define LED_BRIGHTNESS 20
 #define LED_BRIGHTNESS_STEP 10
 #define LED_HUE_STEP 10
+#define LED_CONFIRM_DURATION 500 // ms the check mark is shown
+#ifndef LED_CROSSFADE_FRAMES // may be set by the build, e.g. test/host
+#define LED_CROSSFADE_FRAMES 12   // frames to fade between two times, 0 switches instantly
+#endif
+#define LED_HUE_RATE 50           // hue per second for animations
+#define LED_AUTO_HUE_RATE 4       // hue per second when cycling the color of animations without MODE_CYCLE_HUE
+#define LED_AUTO_HUE_STEP 4       // hue per new time when cycling the time's color (MODE_STATIC)
+#define LED_BRIGHTNESS_RATE 50    // brightness per second when cycling brightness
+#define LED_FADE_RATE 1200        // fade per second for trails, 20 per frame at 60 fps
+#define LED_BPM_BEATS 62          // beats per minute of the bpm animation
+#define LED_MATRIX_TRAIL 4        // rows lit behind a drop's head
+#define LED_MATRIX_SPEED_MIN 90   // rows per second * 16, 5.6 rows/s
+#define LED_MATRIX_SPEED_MAX 240  // rows per second * 16, 15 rows/s
+
+#define LED_POWER_BUDGET 1500 // mA the supply can deliver to the strip, 0 disables the limit
+#define LED_POWER_CHANNEL 20  // mA per color channel at full brightness
+#define LED_POWER_IDLE 1      // mA per dark pixel
+
+#define LED_COMPOSITE_NONE 0 // animations use the whole strip
+#define LED_COMPOSITE_ZERO 1 // animations only show through the words of the time
+#define LED_COMPOSITE_DIM 2  // pixels outside the words are dimmed by LED_COMPOSITE_DIM_SCALE
+#ifndef LED_COMPOSITE // may be set by the build, e.g. test/host
+#define LED_COMPOSITE LED_COMPOSITE_ZERO
+#endif
+#define LED_COMPOSITE_DIM_SCALE 64 // 255 = unchanged, applied every frame, so trails fade faster outside the words
 
 #define RTC_HRS 0
 #define RTC_MINS 1
 #define RTC_SECS 2
-#define RTC_ALIVE_FROM 6     // hour of day
-#define RTC_ALIVE_FROM_MIN 0 // minutes
-#define RTC_ALIVE_TO 22      // hour of day
-#define RTC_ALIVE_TO_MIN 30  // minutes
+#if BOARD_ESP32
+#define RTC_ALARM_PIN 27 // RTC GPIO, wakes the ESP32 from light sleep
+#else
 #define RTC_ALARM_PIN 2
-#define RTC_WAKE_UP_HRS 6
-#define RTC_WAKE_UP_MINS 0
+#endif
+// times the clock is lit: ALIVE_WINDOWS in wordclock_schedule.h
+#define RTC_SQW_CLOCK 1 // count seconds from the 1 Hz square wave on RTC_ALARM_PIN, read the RTC only to sync
 #define MIN_STEP 5
 #define MIN_PARTS 6
+#define MIN_FRAMES 12 // five-minute steps 'past' and 'to', plus the full hour
 
+#if BOARD_ESP32
+#define IR_RECEIVE_PIN 14 // GPIO 6 to 11 are used by the flash
+#else
 #define IR_RECEIVE_PIN 6
-#define IR_PAUSE 3 // timer interrupts
\ No newline at end of file
+#endif
+#define IR_PAUSE 3000   // ms
+#define IR_QUEUE_SIZE 8 // decoded values, power of two
+#define IR_HOLD_ACCELERATION 4 // repeat codes until the step size grows
+#define IR_HOLD_FACTOR_MAX 4   // largest multiple of the step size
+
+#define SCHEDULER_TASKS 6
+#define TASK_RENDER 0
+#define TASK_IR 1
+#define TASK_TIME 2
+#define TASK_SCHEDULE 3
+#define TASK_TELEMETRY 4
+#define TASK_SETTINGS 5
+#define TASK_IR_INTERVAL 20000          // us
+#define TASK_TIME_INTERVAL 1000000      // us
+#define TASK_SCHEDULE_INTERVAL 1000000  // us
+#define TASK_TELEMETRY_INTERVAL 5000000 // us, only used with TELEMETRY
+#define TASK_SETTINGS_INTERVAL 10000    // us, short enough to write a byte whenever the EEPROM is ready
+
+#define SETTINGS_ADDRESS 0  // first EEPROM byte of the settings ring
+#define SETTINGS_SLOTS 8    // records in the ring, spreads the wear
+#define SETTINGS_DELAY 5000 // ms without changes before settings are saved
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef WORDCLOCK_ESP32_HEADER
+#define WORDCLOCK_ESP32_HEADER
+
+#include <EEPROM.h>
+#include <esp_sleep.h>
+
+/*
+  ESP32 target (BOARD_ESP32), not yet built with the ESP32 core, see README.
+
+  The work is split over both cores:
+    - Arduino's core (1) runs loop() with the render, IR, settings and
+      telemetry tasks, everything that touches leds or the LED state.
+    - ESP32_OUTPUT_CORE runs the output task. Finished frames are handed
+      over through a Mailbox (see wordclock_queue.h), the output task
+      copies them into its own frame and shows it with FastLED's RMT or
+      I2S driver. It shares core 1 with loop(), which prepares the next
+      frame while the peripheral shifts out the strip, so the RMT/I2S
+      interrupts do not compete with the IR decoder.
+    - ESP32_CONTROL_CORE runs the control task: polling the IR decoder,
+      reading the RTC and the schedule. Their interrupts are attached
+      from this task, so they are served on this core as well.
+
+  Decoded IR values and the time are handed over lock-free as well, by
+  irQueue and the timeUpdates mailbox.
+
+  Below are the few parts of the AVR tool chain the sketch relies on:
+  Enerlib's Energy and avr/eeprom.h on top of the flash emulated EEPROM.
+*/
+
+#if (LED_OUTPUT != LED_OUTPUT_RMT) && (LED_OUTPUT != LED_OUTPUT_I2S)
+#error "ESP32 drives the strip with LED_OUTPUT_RMT or LED_OUTPUT_I2S"
+#endif
+
+struct frame
+{
+  /**
+   * Pixels to show.
+   */
+  CRGB leds[LED_PIXELS];
+
+  /**
+   * Brightness to show them with, limited by PowerEstimate.
+   */
+  uint8_t brightness;
+
+  /**
+   * First frame after waking up, the output task records the resume time.
+   */
+  bool isResume;
+};
+typedef struct frame Frame;
+
+class Energy
+{
+public:
+  /**
+   * Give up the core until the next FreeRTOS tick, it idles meanwhile.
+   */
+  void Idle()
+  {
+    vTaskDelay(1);
+  }
+
+  /**
+   * Light sleep until the RTC alarm pulls RTC_ALARM_PIN low.
+   * RAM and tasks are kept, both cores continue where they stopped.
+   */
+  void PowerDown()
+  {
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)RTC_ALARM_PIN, 0);
+    esp_light_sleep_start();
+  }
+};
+
+/* EEPROM, the cache in RAM is only written to flash by EEPROM.commit() */
+inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    ((uint8_t *)dst)[i] = EEPROM.read((uintptr_t)src + i);
+}
+
+inline void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+  if (EEPROM.read((uintptr_t)address) != value)
+    EEPROM.write((uintptr_t)address, value);
+}
+
+inline bool eeprom_is_ready()
+{
+  return true;
+}
+
+#endif
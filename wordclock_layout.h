@@ -0,0 +1,87 @@
+#ifndef WORDCLOCK_LAYOUT_HEADER
+#define WORDCLOCK_LAYOUT_HEADER
+
+/*
+  Generated by tools/layout.py from tools/layout_en.txt, do not edit.
+
+    ITKISGHALFE
+    TENYQUARTER
+    DTWENTYFIVE
+    TOPASTEFOUR
+    FIVETWONINE
+    THREETWELVE
+    BELEVENONES
+    SEVENWEIGHT
+    ITENSIXTIES
+    TIAMOICPMCK
+    X0123456789
+*/
+
+static_assert(LED_ROWS == 11 && LED_COLUMNS == 11, "layout does not match the matrix");
+
+INDEXES(IT, 0, 1);
+constexpr Word IT PROGMEM = WORD(IT);
+
+INDEXES(IS, 3, 4);
+constexpr Word IS PROGMEM = WORD(IS);
+
+INDEXES(M5, 29, 30, 31, 32);
+INDEXES(M10, 21, 20, 19);
+INDEXES(M15, 7, 17, 16, 15, 14, 13, 12, 11); // >> "a quarter"
+INDEXES(M20, 23, 24, 25, 26, 27, 28);
+INDEXES(M25, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32); // only for simplicity
+INDEXES(M30, 6, 7, 8, 9);
+constexpr Word W_MINS[] PROGMEM = {
+    WORD(M5), WORD(M10), WORD(M15),
+    WORD(M20), WORD(M25), WORD(M30)};
+
+INDEXES(TO, 43, 42);
+constexpr Word TO PROGMEM = WORD(TO);
+
+INDEXES(PAST, 41, 40, 39, 38);
+constexpr Word PAST PROGMEM = WORD(PAST);
+
+INDEXES(H12, 60, 59, 58, 57, 56, 55);
+INDEXES(H1, 73, 74, 75);
+INDEXES(H2, 48, 49, 50);
+INDEXES(H3, 65, 64, 63, 62, 61);
+INDEXES(H4, 36, 35, 34, 33);
+INDEXES(H5, 44, 45, 46, 47);
+INDEXES(H6, 92, 93, 94);
+INDEXES(H7, 87, 86, 85, 84, 83);
+INDEXES(H8, 81, 80, 79, 78, 77);
+INDEXES(H9, 51, 52, 53, 54);
+INDEXES(H10, 89, 90, 91);
+INDEXES(H11, 67, 68, 69, 70, 71, 72);
+constexpr Word W_HOURS[] PROGMEM = {
+    WORD(H12), WORD(H1), WORD(H2),
+    WORD(H3), WORD(H4), WORD(H5),
+    WORD(H6), WORD(H7), WORD(H8),
+    WORD(H9), WORD(H10), WORD(H11)};
+
+INDEXES(AM, 107, 106);
+constexpr Word AM PROGMEM = WORD(AM);
+
+INDEXES(PM, 102, 101);
+constexpr Word PM PROGMEM = WORD(PM);
+
+LABEL(S);
+constexpr Digit SCHEDULE PROGMEM = {T_S, 110}; // pseudo-digit
+
+LABEL(D0);
+LABEL(D1);
+LABEL(D2);
+LABEL(D3);
+LABEL(D4);
+LABEL(D5);
+LABEL(D6);
+LABEL(D7);
+LABEL(D8);
+LABEL(D9);
+constexpr Digit DIGITS[] PROGMEM = {
+    {T_D0, 111}, {T_D1, 112}, {T_D2, 113}, {T_D3, 114}, {T_D4, 115}, {T_D5, 116}, {T_D6, 117}, {T_D7, 118}, {T_D8, 119}, {T_D9, 120}};
+
+INDEXES(CHK, 64, 68, 84, 92, 82, 72, 58, 52, 34);
+constexpr Word CHK PROGMEM = WORD(CHK);
+
+#endif
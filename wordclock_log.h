@@ -0,0 +1,83 @@
+#ifndef WORDCLOCK_LOG_HEADER
+#define WORDCLOCK_LOG_HEADER
+
+/*
+  Deferred debug log.
+
+  Recording an event only copies a pointer to its PROGMEM text, a value
+  and a timestamp into a ring buffer. drain() prints as many events as
+  fit into the free space of the Serial TX buffer, so printing never
+  blocks. Events which do not fit into the ring buffer are counted and
+  reported with the next drained event.
+*/
+
+#define LOG_LINE_MAX 48 // free TX buffer needed to print one event, texts up to 20 characters
+
+struct logEntry
+{
+  /**
+   * Event text in PROGMEM, created with F().
+   */
+  const __FlashStringHelper *text;
+
+  /**
+   * Small argument, e.g. a key code or a mode.
+   */
+  uint16_t value;
+
+  /**
+   * Number base to print the value with, DEC or HEX.
+   */
+  uint8_t base;
+
+  /**
+   * millis() when recorded, lower 16 bit.
+   */
+  uint16_t at;
+};
+typedef struct logEntry LogEntry;
+
+template <uint8_t N>
+class DebugLog
+{
+public:
+  DebugLog() : entries(), reported(0){};
+
+  void record(const __FlashStringHelper *text, uint16_t value, uint8_t base)
+  {
+    LogEntry entry = {text, value, base, (uint16_t)millis()};
+    entries.push(entry);
+  }
+
+  /**
+   * Print pending events without blocking, call while idle.
+   */
+  void drain(HardwareSerial &out)
+  {
+    LogEntry entry;
+    while ((out.availableForWrite() >= LOG_LINE_MAX) && entries.pop(entry))
+    {
+      uint8_t dropped = entries.getDropped();
+      if (dropped != reported)
+      {
+        out.print(F("(dropped "));
+        out.print((uint8_t)(dropped - reported));
+        out.print(F(") "));
+        reported = dropped;
+      }
+      out.print(entry.at);
+      out.print(' ');
+      out.print(entry.text);
+      out.print(' ');
+      if (entry.base == HEX)
+        out.print(F("0x"));
+      out.println(entry.value, entry.base);
+    }
+  }
+
+private:
+  RingBuffer<LogEntry, N> entries;
+  uint8_t reported; // dropped events which were already reported
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef WORDCLOCK_MASK_HEADER
+#define WORDCLOCK_MASK_HEADER
+
+/*
+  Time to word mapping.
+
+  Builds the pixel mask for a time from the frame masks of a layout,
+  see WordLayout in wordclock_constants.h. Only needs <stdint.h> and
+  pgm_read_byte, no global state and no hardware. test/host/test_time.cpp
+  checks all minutes of a day.
+*/
+
+/**
+ * Determine if minutes should be displayed.
+ * This is not necessary if minutes are 0.
+ * Or, in range of 55 to 60, as the clock shows "future" 5-minute-steps.
+ */
+inline bool showsMinutes(uint8_t minutes)
+{
+  return ((minutes < 56) || (minutes == 0));
+}
+
+/**
+ * Calculate the frame step of FRAME_MINS for the given minutes.
+ */
+inline uint8_t getFrameStep(uint8_t minutes)
+{
+  if (!showsMinutes(minutes))
+    return MIN_FRAMES - 1; // full hour ahead
+
+  if (minutes < 30)
+    return minutes / MIN_STEP;
+
+  if (minutes > 30)
+    return MIN_PARTS + ((minutes - 31) / MIN_STEP);
+
+  return MIN_PARTS - 1; // index for 'half'
+}
+
+/**
+ * Set a single pixel within a mask.
+ */
+inline void setMaskBit(uint8_t *mask, LedIndex ledNo)
+{
+  mask[ledNo >> 3] |= (1 << (ledNo & 7));
+}
+
+/**
+ * Combine the precomputed frame masks for the given time.
+ */
+template <typename Layout>
+inline void setTimeMask(uint8_t *mask, uint8_t hours, uint8_t minutes, bool withSchedule)
+{
+  const uint8_t *mins = Layout::frameMins(getFrameStep(minutes));
+  const uint8_t *hrs = Layout::frameHours(((minutes > 30) ? hours + 1 : hours) % 12); // to : past
+  const uint8_t *daytime = Layout::frameDaytime(hours > 12);                          // PM : AM
+
+  for (uint8_t i = 0; i < Layout::Grid::MASK_BYTES; i++)
+    mask[i] = pgm_read_byte(mins + i) | pgm_read_byte(hrs + i) | pgm_read_byte(daytime + i);
+
+  // digits representing the actual minutes, e.g. 34 => 3 and 4
+  if (minutes < 60) // a corrupted time must not index past the ten digits
+  {
+    setMaskBit(mask, digitLed(Layout::digit(minutes / 10)));
+    setMaskBit(mask, digitLed(Layout::digit(minutes % 10)));
+  }
+
+  // keep the schedule indicator, so the overlay does not dirty every frame
+  if (withSchedule)
+    setMaskBit(mask, digitLed(Layout::schedule()));
+}
+
+#endif
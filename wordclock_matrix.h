@@ -0,0 +1,156 @@
+#ifndef WORDCLOCK_MATRIX_HEADER
+#define WORDCLOCK_MATRIX_HEADER
+
+/*
+  2D access to the LED strip.
+
+  The strip is laid out in rows with alternating direction:
+     0  1  2  3
+     7  6  5  4
+     8  9 10 11 ...
+
+  Geometry<Rows, Cols> derives everything size dependent at compile time:
+  the amount of pixels and mask bytes, the smallest index type which can
+  address every pixel, and the XY map translating (row, column) into the
+  strip index. The map is stored in PROGMEM, so a pixel access costs one
+  table load.
+*/
+
+/* Compile-time index sequence, to expand a function for every pixel */
+template <uint16_t... Is>
+struct Indices
+{
+};
+
+template <uint16_t N, uint16_t... Is>
+struct MakeIndices : MakeIndices<N - 1, N - 1, Is...>
+{
+};
+
+template <uint16_t... Is>
+struct MakeIndices<0, Is...>
+{
+  typedef Indices<Is...> type;
+};
+
+/**
+ * 8-bit strip indexes up to 255 pixels, 16-bit above.
+ */
+template <bool Wide>
+struct StripIndex
+{
+  typedef uint8_t type;
+};
+
+template <>
+struct StripIndex<true>
+{
+  typedef uint16_t type;
+};
+
+inline uint8_t pgmRead(const uint8_t *p)
+{
+  return pgm_read_byte(p);
+}
+
+inline uint16_t pgmRead(const uint16_t *p)
+{
+  return pgm_read_word(p);
+}
+
+template <typename G, typename I>
+struct SerpentineTable;
+
+template <uint8_t Rows, uint8_t Cols>
+struct Geometry
+{
+  static constexpr uint8_t ROWS = Rows;
+  static constexpr uint8_t COLUMNS = Cols;
+  static constexpr uint16_t PIXELS = Rows * Cols;
+  static constexpr uint8_t MASK_BYTES = (PIXELS + 7) / 8; // one bit per pixel
+
+  typedef typename StripIndex<(PIXELS > 255)>::type Index; // also holds PIXELS, the loop bound
+  typedef SerpentineTable<Geometry, typename MakeIndices<PIXELS>::type> Map;
+
+  /**
+   * Strip index for the i-th pixel in row-major order.
+   */
+  static constexpr Index serpentine(uint16_t i)
+  {
+    return (((i / Cols) % 2) == 0)
+               ? i
+               : ((i / Cols) * Cols) + (Cols - 1 - (i % Cols));
+  }
+
+  /**
+   * Strip index of the pixel at the given row and column.
+   */
+  static Index xy(uint8_t row, uint8_t col)
+  {
+    return pgmRead(&Map::map[(row * Cols) + col]);
+  }
+};
+
+template <uint8_t Rows, uint8_t Cols>
+constexpr uint8_t Geometry<Rows, Cols>::ROWS;
+template <uint8_t Rows, uint8_t Cols>
+constexpr uint8_t Geometry<Rows, Cols>::COLUMNS;
+template <uint8_t Rows, uint8_t Cols>
+constexpr uint16_t Geometry<Rows, Cols>::PIXELS;
+template <uint8_t Rows, uint8_t Cols>
+constexpr uint8_t Geometry<Rows, Cols>::MASK_BYTES;
+
+template <typename G, uint16_t... Is>
+struct SerpentineTable<G, Indices<Is...>>
+{
+  static const typename G::Index map[sizeof...(Is)];
+};
+
+template <typename G, uint16_t... Is>
+const typename G::Index SerpentineTable<G, Indices<Is...>>::map[sizeof...(Is)] PROGMEM = {G::serpentine(Is)...};
+
+/**
+ * Thin 2D view over the leds array.
+ */
+template <typename G>
+class LedMatrix
+{
+public:
+  LedMatrix(CRGB *leds) : leds(leds){};
+
+  CRGB &operator()(uint8_t row, uint8_t col)
+  {
+    return leds[G::xy(row, col)];
+  }
+
+private:
+  CRGB *leds;
+};
+
+/* Matrix animation */
+struct drop
+{
+  /**
+   * Row of the drop's head, 8.8 fixed point.
+   * Negative while waiting to enter the first row.
+   */
+  int16_t head;
+
+  /**
+   * Rows per second, 4.4 fixed point. 0 until first spawned.
+   */
+  uint8_t speed;
+
+  /**
+   * Remainder of the head's movement, see AnimationClock::step().
+   */
+  uint16_t fraction;
+
+  /**
+   * Color of the drop.
+   */
+  uint8_t hue;
+};
+typedef struct drop Drop;
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef WORDCLOCK_MODES_HEADER
+#define WORDCLOCK_MODES_HEADER
+
+/*
+  LED modes.
+
+  LED_MODES describes every mode in the order of LED_MODE_*: the function
+  rendering its frames, the frame rate of the render task, how it is
+  treated by handleLeds and the IR key selecting it. A new effect only
+  needs its LED_MODE_* index, a render function and an entry here.
+
+  The table is read in place from PROGMEM, handleLeds dispatches with a
+  single indexed call per frame.
+*/
+
+#define MODE_CYCLE_HUE (1 << 0) // hue runs at LED_HUE_RATE, instead of LED_AUTO_HUE_RATE with autoCycleHue
+#define MODE_STATIC (1 << 1)    // frames only change with the time or its color, autoCycleHue steps with a new time
+
+typedef void (*RenderFunction)();
+
+struct ledModeInfo
+{
+  /**
+   * Short description for debugging.
+   */
+  const char *text;
+
+  /**
+   * Renders the next frame into leds.
+   */
+  RenderFunction render;
+
+  /**
+   * Frames per second, sets the interval of the render task.
+   */
+  uint8_t fps;
+
+  /**
+   * MODE_* bits.
+   */
+  uint8_t flags;
+
+  /**
+   * IR key selecting the mode, first 16 bits as with IR_*.
+   */
+  uint16_t irKey;
+};
+typedef struct ledModeInfo LedModeInfo;
+
+#define MODE_LABEL(name) constexpr char M_##name[] PROGMEM = ">>" #name
+
+MODE_LABEL(NORMAL);
+MODE_LABEL(RAINBOW);
+MODE_LABEL(RAINBOW_GLITTER);
+MODE_LABEL(CONFETTI);
+MODE_LABEL(SINELON);
+MODE_LABEL(BPM);
+MODE_LABEL(JUGGLE);
+MODE_LABEL(MATRIX);
+
+constexpr LedModeInfo LED_MODES[] PROGMEM = {
+    {M_NORMAL, handleDisplayTime, 25, MODE_STATIC, IR_ZERO},
+    {M_RAINBOW, renderRainbow, 60, MODE_CYCLE_HUE, IR_ONE},
+    {M_RAINBOW_GLITTER, renderRainbowWithGlitter, 60, MODE_CYCLE_HUE, IR_TWO},
+    {M_CONFETTI, renderConfetti, 60, 0, IR_THREE},
+    {M_SINELON, renderSinelon, 60, MODE_CYCLE_HUE, IR_FOUR},
+    {M_BPM, renderBpm, 60, 0, IR_FIVE},
+    {M_JUGGLE, renderJuggle, 60, MODE_CYCLE_HUE, IR_SIX},
+    {M_MATRIX, renderMatrix, 60, 0, IR_SEVEN}};
+
+constexpr uint8_t LED_MODE_COUNT = sizeof(LED_MODES) / sizeof(LED_MODES[0]);
+static_assert(LED_MODE_COUNT == LED_MODE_MATRIX + 1, "LED_MODES has to list every LED_MODE_*");
+
+/* Accessors */
+inline RenderFunction modeRender(uint8_t mode)
+{
+  return (RenderFunction)pgm_read_ptr(&LED_MODES[mode].render);
+}
+
+inline uint8_t modeFps(uint8_t mode)
+{
+  return pgm_read_byte(&LED_MODES[mode].fps);
+}
+
+inline bool hasModeFlag(uint8_t mode, uint8_t flag)
+{
+  return pgm_read_byte(&LED_MODES[mode].flags) & flag;
+}
+
+inline uint16_t modeKey(uint8_t mode)
+{
+  return pgm_read_word(&LED_MODES[mode].irKey);
+}
+
+inline const __FlashStringHelper *modeText(uint8_t mode)
+{
+  return (const __FlashStringHelper *)pgm_read_ptr(&LED_MODES[mode].text);
+}
+
+#endif
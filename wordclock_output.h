@@ -0,0 +1,168 @@
+#ifndef WORDCLOCK_OUTPUT_HEADER
+#define WORDCLOCK_OUTPUT_HEADER
+
+/*
+  Alternative output for the WS2812B strip (LED_OUTPUT_USART).
+
+  FastLED's clockless driver bit-bangs the strip and has to disable
+  interrupts for the whole frame. Here USART0 runs as SPI master (MSPIM)
+  and shifts out the WS2812B timing instead, so interrupts stay enabled.
+
+  Every WS2812B bit is encoded as four USART bits at 2.67 MHz (375 ns each):
+      0 => 1000  (375 ns high, 1125 ns low)
+      1 => 1100  (750 ns high,  750 ns low)
+
+  One USART byte always holds two complete WS2812B bits and ends low.
+
+  Interrupts delaying the next byte:
+    - UDR0 buffers one byte while the previous one is shifted out, so an
+      ISR may delay a refill by up to one byte (3 us). A longer delay
+      lets the shift register run empty, which happens with nearly
+      every Timer0 or IRremote tick and is harmless as long as the line
+      does not stay low for the reset time.
+    - The datasheet does not state the TXD level while the transmitter
+      is idle in MSPIM mode, and it was not checked on a scope. The gap
+      only stretches the low phase if the line stays at its last bit,
+      which is low. The pixels latch once the line is low for the reset
+      time, 50 us by the WS2812B datasheet (280 us for newer parts), and
+      the rest of the frame would start over at the first pixel.
+    - The long ISR is irrecv.decode() in the Timer1 ISR: once a signal
+      is complete it runs IRremote's decoders over the raw buffer. It is
+      deferred while a frame is sent (isSending), the receiver keeps the
+      signal until the next tick. The ISRs left (Timer0 millis, the
+      IRremote 50 us sampling tick, the Timer1 tick count and the RTC
+      alarm) are short and without loops, together well below the reset
+      time. These are estimates, no latency was measured.
+    - Gaps that may latch are detected by timing the refills against
+      Timer0 (4 us per count): a refill LED_USART_GAP_TICKS or more
+      after the previous one is counted, shorter gaps are not. The
+      time stamp and the write are taken with interrupts off, so no
+      ISR can fall between them. Gaps of 1 ms and more wrap Timer0 and
+      are missed, no ISR of the sketch runs that long.
+    - A frame with such a gap is sent again by the next render run
+      (takeUnderrun), at most LED_USART_RESENDS times in a row, so a
+      latched partial frame is only shown for a frame period and a
+      steady ISR load cannot keep the strip busy. How often it fires
+      with IR enabled was not measured, gaps counts them for a
+      debugger (Serial is taken by the strip).
+
+  At the end of a frame the transmitter is switched off, TXD then falls
+  back to PORTD1 which drives it low, so the latch between frames does
+  not depend on the idle level of the USART.
+
+  Wiring: data has to be connected to TXD (D1), XCK (D4) is used as
+  clock output and has to stay unconnected. Serial cannot be used.
+*/
+#if LED_OUTPUT == LED_OUTPUT_USART
+
+#define LED_USART_UBRR 2      // f_xck = BOARD_FREQ / (2 * (UBRR + 1)) = 2.67 MHz
+#define LED_USART_RESET_US 50 // low time the WS2812B latch on
+#define LED_USART_RESENDS 2   // frames sent again in a row after gaps
+#define LED_USART_GAP_TICKS (LED_USART_RESET_US * (BOARD_FREQ / 1000000UL) / 64) // in Timer0 counts, prescaler 64
+
+/**
+ * USART symbols for two WS2812B bits each, MSB first.
+ */
+const uint8_t WS2812_SYMBOLS[4] PROGMEM = {0x88, 0x8C, 0xC8, 0xCC};
+
+template <EOrder RGB_ORDER>
+class UsartWS2812Controller : public CPixelLEDController<RGB_ORDER>
+{
+public:
+  UsartWS2812Controller() : isSending(false), gaps(0), hasUnderrun(false), resends(0), lastWrite(0){};
+
+  /**
+   * Configure USART0 as SPI master, TXD is driven low while it is off.
+   */
+  virtual void init()
+  {
+    PORTD &= ~(1 << PORTD1);                  // TXD low while the transmitter is off
+    DDRD |= (1 << DDD1) | (1 << DDD4);        // XCK as output enables master mode
+    UCSR0C = (1 << UMSEL01) | (1 << UMSEL00); // MSPIM, MSB first, SPI mode 0
+  }
+
+  /**
+   * Whether the last frame had a gap that may have latched and has to be
+   * sent again, clears it. False after LED_USART_RESENDS in a row.
+   */
+  bool takeUnderrun()
+  {
+    bool shouldResend = hasUnderrun && (resends < LED_USART_RESENDS);
+    resends = shouldResend ? (resends + 1) : 0;
+    hasUnderrun = false;
+    return shouldResend;
+  }
+
+  /**
+   * A frame is being shifted out, long ISRs should wait.
+   */
+  volatile bool isSending;
+
+  /**
+   * Gaps of the reset time within frames, since init.
+   */
+  uint16_t gaps;
+
+protected:
+  /**
+   * Send all pixels, FastLED handles color order, brightness and dithering.
+   */
+  virtual void showPixels(PixelController<RGB_ORDER> &pixels)
+  {
+    isSending = true;
+    UBRR0 = 0;
+    UCSR0B = (1 << TXEN0);  // the USART takes over TXD
+    UBRR0 = LED_USART_UBRR; // baud rate has to be set after enabling the transmitter
+    UCSR0A |= (1 << TXC0);  // clear transmit complete flag (written as one)
+    lastWrite = TCNT0;
+
+    pixels.preStepFirstByteDithering();
+    while (pixels.has(1))
+    {
+      writeByte(pixels.loadAndScale0());
+      writeByte(pixels.loadAndScale1());
+      writeByte(pixels.loadAndScale2());
+      pixels.advanceData();
+      pixels.stepDithering();
+    }
+
+    // wait for the last symbol to leave the shift register
+    while (!(UCSR0A & (1 << TXC0)))
+    {
+    }
+    UCSR0B = 0; // TXD is driven low by the port again, the pixels latch
+    isSending = false;
+  }
+
+private:
+  bool hasUnderrun;
+  uint8_t resends;   // frames sent again in a row
+  uint8_t lastWrite; // TCNT0 at the previous refill
+
+  void writeByte(uint8_t b)
+  {
+    for (int8_t shift = 6; shift >= 0; shift -= 2)
+    {
+      uint8_t symbol = pgm_read_byte(&WS2812_SYMBOLS[(b >> shift) & 3]);
+      while (!(UCSR0A & (1 << UDRE0)))
+      {
+      }
+      noInterrupts(); // no ISR between the time stamp and the write
+      uint8_t now = TCNT0;
+      UDR0 = symbol;
+      UCSR0A |= (1 << TXC0); // UDR0 is full, the shift register cannot run empty before this
+      interrupts();
+
+      if ((uint8_t)(now - lastWrite) >= LED_USART_GAP_TICKS)
+      {
+        hasUnderrun = true; // the line may have been low for the reset time
+        gaps++;
+      }
+      lastWrite = now;
+    }
+  }
+};
+
+#endif
+
+#endif
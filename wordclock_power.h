@@ -0,0 +1,105 @@
+#ifndef WORDCLOCK_POWER_HEADER
+#define WORDCLOCK_POWER_HEADER
+
+/*
+  Estimated current draw of the strip.
+
+  The sum of all color channels is kept up to date with every pixel
+  written through Wordclock::setPixel. A black strip clears it.
+
+  The animation kernels write leds directly. With LED_COMPOSITE_ZERO
+  only the pixels of the time mask are left lit after compositing, so
+  only those are summed up again, about a fifth of the face. Without
+  compositing, or with LED_COMPOSITE_DIM, the kernels leave every pixel
+  changed: fadeToBlackBy, fill_rainbow and the dimming touch all of
+  them each frame. There the whole strip is summed up once per frame,
+  per pixel deltas would cost a subtraction on top of every addition
+  and could not be fed from FastLED's fill functions anyway.
+
+  From the sum and the global brightness the draw in mA is estimated,
+  limitBrightness() returns the highest brightness which stays within
+  LED_POWER_BUDGET.
+*/
+
+static_assert((LED_POWER_BUDGET == 0) || (LED_POWER_BUDGET > LED_PIXELS * LED_POWER_IDLE), "LED_POWER_BUDGET does not even cover the dark strip");
+
+class PowerEstimate
+{
+public:
+  PowerEstimate() : units(0){};
+
+  /**
+   * Account for a pixel changing from one color to another.
+   */
+  void update(const CRGB &from, const CRGB &to)
+  {
+    units -= (uint16_t)from.r + from.g + from.b;
+    units += (uint16_t)to.r + to.g + to.b;
+  }
+
+  /**
+   * All pixels were set to black.
+   */
+  void clear()
+  {
+    units = 0;
+  }
+
+  /**
+   * Sum up all pixels again, after they were written directly.
+   */
+  void rescan(const CRGB *leds)
+  {
+    units = 0;
+    for (LedIndex i = 0; i < LED_PIXELS; i++)
+      units += (uint16_t)leds[i].r + leds[i].g + leds[i].b;
+  }
+
+  /**
+   * Sum up only the pixels of mask, all others are known to be black.
+   */
+  void rescan(const CRGB *leds, const uint8_t *mask)
+  {
+    units = 0;
+    for (uint8_t b = 0; b < LED_MASK_BYTES; b++)
+    {
+      uint8_t bits = mask[b];
+      for (LedIndex i = b * 8; bits != 0; i++, bits >>= 1)
+      {
+        if (bits & 1)
+          units += (uint16_t)leds[i].r + leds[i].g + leds[i].b;
+      }
+    }
+  }
+
+  /**
+   * Estimated draw in mA at the given brightness.
+   */
+  uint16_t milliamps(uint8_t brightness)
+  {
+    uint32_t active = (units * LED_POWER_CHANNEL * brightness) / (255UL * 255UL);
+    return (LED_PIXELS * LED_POWER_IDLE) + active;
+  }
+
+  /**
+   * Highest brightness up to the requested one within LED_POWER_BUDGET.
+   */
+  uint8_t limitBrightness(uint8_t brightness)
+  {
+#if LED_POWER_BUDGET > 0
+    if (milliamps(brightness) <= LED_POWER_BUDGET)
+      return brightness;
+
+    uint32_t available = LED_POWER_BUDGET - (LED_PIXELS * LED_POWER_IDLE);
+    uint32_t limit = (available * 255UL * 255UL) / (units * LED_POWER_CHANNEL);
+    return (limit < 2) ? 2 : limit; // FastLED treats brightness of 0 as if it is 255
+#else
+    return brightness;
+#endif
+  }
+
+private:
+  uint32_t units; // sum of all color channels, up to LED_PIXELS * 3 * 255
+};
+
+#endif
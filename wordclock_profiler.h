@@ -0,0 +1,113 @@
+#ifndef WORDCLOCK_PROFILER_HEADER
+#define WORDCLOCK_PROFILER_HEADER
+
+/*
+  Frame-time profiler for debugging builds.
+
+  Each stage keeps min/max/sum of its durations in microseconds. Stages
+  are measured with PROFILE_BEGIN/PROFILE_END (see wordclock.ino), which
+  compile to nothing unless DEBUG_PROFILE is set. Sending 'p' over Serial
+  dumps the statistics and starts a new measurement.
+*/
+
+#define PROFILE_IR 0      // handleIRresults
+#define PROFILE_RTC 1     // theClock.read
+#define PROFILE_KERNEL 2  // animation kernel or time display in handleLeds
+#define PROFILE_OVERLAY 3 // SCHEDULE and CHK
+#define PROFILE_SHOW 4    // FastLED.show
+#define PROFILE_IDLE 5    // idle sleep while no task is due
+#define PROFILE_STAGES 6
+
+LABEL(PROFILE_IR);
+LABEL(PROFILE_RTC);
+LABEL(PROFILE_KERNEL);
+LABEL(PROFILE_OVERLAY);
+LABEL(PROFILE_SHOW);
+LABEL(PROFILE_IDLE);
+
+constexpr const char *PROFILE_LABELS[PROFILE_STAGES] PROGMEM = {
+    T_PROFILE_IR, T_PROFILE_RTC, T_PROFILE_KERNEL, T_PROFILE_OVERLAY, T_PROFILE_SHOW, T_PROFILE_IDLE};
+
+struct stageStats
+{
+  /**
+   * Shortest and longest run in microseconds.
+   */
+  uint16_t min;
+  uint16_t max;
+
+  /**
+   * Sum of all runs in microseconds, for the mean.
+   */
+  uint32_t sum;
+
+  /**
+   * Amount of runs.
+   */
+  uint16_t count;
+};
+typedef struct stageStats StageStats;
+
+class Profiler
+{
+public:
+  Profiler() : stats(), started(){};
+
+  void begin(uint8_t stage)
+  {
+    started[stage] = micros();
+  }
+
+  /**
+   * Add the time since begin() to the stage's statistics.
+   */
+  void end(uint8_t stage)
+  {
+    uint32_t elapsed = micros() - started[stage];
+    record(stage, (elapsed > 0xFFFF) ? 0xFFFF : elapsed);
+  }
+
+  void record(uint8_t stage, uint16_t us)
+  {
+    StageStats &s = stats[stage];
+    if (s.count == 0xFFFF)
+      return; // full, mean would overflow soon
+    if ((s.count == 0) || (us < s.min))
+      s.min = us;
+    if (us > s.max)
+      s.max = us;
+    s.sum += us;
+    s.count++;
+  }
+
+  /**
+   * Print one line per stage: name, count, min, mean, max (us).
+   */
+  void dump(Print &out)
+  {
+    for (uint8_t i = 0; i < PROFILE_STAGES; i++)
+    {
+      const StageStats &s = stats[i];
+      out.print((const __FlashStringHelper *)pgm_read_ptr(&PROFILE_LABELS[i]));
+      out.print(F("\tn="));
+      out.print(s.count);
+      out.print(F("\tmin="));
+      out.print(s.min);
+      out.print(F("\tmean="));
+      out.print((s.count > 0) ? (s.sum / s.count) : 0);
+      out.print(F("\tmax="));
+      out.println(s.max);
+    }
+  }
+
+  void reset()
+  {
+    memset(stats, 0, sizeof(stats));
+  }
+
+private:
+  StageStats stats[PROFILE_STAGES];
+  uint32_t started[PROFILE_STAGES];
+};
+
+#endif
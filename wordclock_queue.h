@@ -0,0 +1,152 @@
+#ifndef WORDCLOCK_QUEUE_HEADER
+#define WORDCLOCK_QUEUE_HEADER
+
+/*
+  Lock-free hand-over between a single producer and a single consumer,
+  e.g. an ISR pushing and the main loop popping, or two tasks on the
+  cores of an ESP32.
+
+  RingBuffer queues values. The producer only writes head, the consumer
+  only writes tail. Both are single bytes, so reading them is atomic
+  without disabling interrupts. One slot stays empty to tell a full from
+  an empty buffer.
+
+  Mailbox hands over the latest value, e.g. a whole frame. It is one
+  half of a double buffer: the consumer copies the value into its own
+  buffer and releases the mailbox right away, so the producer can fill
+  it again while the consumer works on the copy.
+*/
+
+#if BOARD_ESP32
+#define PUBLISH_BARRIER() __sync_synchronize() // the other side may run on the other core
+#else
+#define PUBLISH_BARRIER() __asm__ __volatile__("" ::: "memory")
+#endif
+
+template <typename T, uint8_t N>
+class RingBuffer
+{
+  static_assert((N & (N - 1)) == 0, "ring buffer size has to be a power of two");
+
+public:
+  RingBuffer() : items(), head(0), tail(0), dropped(0){};
+
+  /**
+   * Add an item, producer side.
+   * Returns false and counts the item as dropped when full.
+   */
+  bool push(const T &item)
+  {
+    uint8_t next = (head + 1) & (N - 1);
+    if (next == tail)
+    {
+      dropped++;
+      return false;
+    }
+
+    items[head] = item;
+    PUBLISH_BARRIER(); // item has to be written before it is published
+    head = next;
+    return true;
+  }
+
+  /**
+   * Take the oldest item, consumer side.
+   * Returns false when empty.
+   */
+  bool pop(T &item)
+  {
+    if (tail == head)
+      return false;
+
+    item = items[tail];
+    PUBLISH_BARRIER(); // item has to be read before its slot is released
+    tail = (tail + 1) & (N - 1);
+    return true;
+  }
+
+  bool isEmpty()
+  {
+    return (tail == head);
+  }
+
+  /**
+   * Amount of items which did not fit into the buffer.
+   */
+  uint8_t getDropped()
+  {
+    return dropped;
+  }
+
+private:
+  T items[N];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  volatile uint8_t dropped;
+};
+
+template <typename T>
+class Mailbox
+{
+public:
+  Mailbox() : item(), isFull(false){};
+
+  /**
+   * Space to write the next value into, producer side.
+   * NULL while the consumer did not take the previous one yet.
+   */
+  T *claim()
+  {
+    return isFull ? NULL : &item;
+  }
+
+  /**
+   * Hand over the value written into claim().
+   */
+  void publish()
+  {
+    PUBLISH_BARRIER(); // value has to be written before it is published
+    isFull = true;
+  }
+
+  /**
+   * Hand over a copy of the value, producer side.
+   * Returns false while the consumer did not take the previous one yet.
+   */
+  bool put(const T &value)
+  {
+    T *next = claim();
+    if (next == NULL)
+      return false;
+
+    *next = value;
+    publish();
+    return true;
+  }
+
+  /**
+   * Copy the value and release the mailbox, consumer side.
+   * Returns false when nothing was handed over.
+   */
+  bool take(T &value)
+  {
+    if (!isFull)
+      return false;
+
+    value = item;
+    PUBLISH_BARRIER(); // value has to be read before the mailbox is released
+    isFull = false;
+    return true;
+  }
+
+  bool isEmpty()
+  {
+    return !isFull;
+  }
+
+private:
+  T item;
+  volatile bool isFull;
+};
+
+#endif
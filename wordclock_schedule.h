@@ -0,0 +1,114 @@
+#ifndef WORDCLOCK_SCHEDULE_HEADER
+#define WORDCLOCK_SCHEDULE_HEADER
+
+/*
+  Weekly sleep schedule.
+
+  ALIVE_WINDOWS lists when the clock is lit, all other times it sleeps.
+  A window applies to the days in its mask and ends on the same day, to
+  stay lit over midnight split it into two windows. Times are handled as
+  minutes of the week, Sunday 00:00 being 0 (tmElements_t.Wday 1).
+
+  nextAliveMinute() computes when the next window starts, so the RTC can
+  be set to wake the board exactly then.
+*/
+
+#define DAY_SUN (1 << 0)
+#define DAY_MON (1 << 1)
+#define DAY_TUE (1 << 2)
+#define DAY_WED (1 << 3)
+#define DAY_THU (1 << 4)
+#define DAY_FRI (1 << 5)
+#define DAY_SAT (1 << 6)
+#define DAY_WEEKDAYS (DAY_MON | DAY_TUE | DAY_WED | DAY_THU | DAY_FRI)
+#define DAY_WEEKEND (DAY_SAT | DAY_SUN)
+#define DAY_ALL (DAY_WEEKDAYS | DAY_WEEKEND)
+
+#define MINUTES_PER_DAY 1440
+#define MINUTES_PER_WEEK 10080
+
+struct aliveWindow
+{
+  /**
+   * Days the window applies to, DAY_* bits.
+   */
+  uint8_t days;
+
+  /**
+   * First minute of the day the clock is lit.
+   */
+  uint16_t from;
+
+  /**
+   * First minute of the day the clock sleeps again, up to MINUTES_PER_DAY.
+   */
+  uint16_t to;
+};
+typedef struct aliveWindow AliveWindow;
+
+#define AT(hours, minutes) (((hours) * 60) + (minutes))
+
+/**
+ * Times the clock is lit, e.g. for a weekday morning and evening:
+ *   {DAY_WEEKDAYS, AT(6, 0), AT(8, 0)},
+ *   {DAY_WEEKDAYS, AT(17, 0), AT(22, 30)},
+ *   {DAY_WEEKEND, AT(8, 0), AT(23, 0)}
+ * May be set by the build, e.g. test/host.
+ */
+#ifndef SCHEDULE_WINDOWS
+#define SCHEDULE_WINDOWS {DAY_ALL, AT(6, 0), AT(22, 30)}
+#endif
+
+constexpr AliveWindow ALIVE_WINDOWS[] PROGMEM = {SCHEDULE_WINDOWS};
+
+constexpr uint8_t ALIVE_WINDOW_COUNT = sizeof(ALIVE_WINDOWS) / sizeof(ALIVE_WINDOWS[0]);
+
+/**
+ * Minute of the week for a weekday (1 = Sunday) and time.
+ */
+inline uint16_t minuteOfWeek(uint8_t wday, uint8_t hours, uint8_t minutes)
+{
+  return ((((wday + 6) % 7) * MINUTES_PER_DAY) + AT(hours, minutes)) % MINUTES_PER_WEEK;
+}
+
+/**
+ * Check if the clock should be lit at a minute of the week.
+ */
+inline bool isAliveAt(uint16_t minute)
+{
+  uint8_t day = 1 << (minute / MINUTES_PER_DAY);
+  uint16_t time = minute % MINUTES_PER_DAY;
+  for (uint8_t i = 0; i < ALIVE_WINDOW_COUNT; i++)
+  {
+    if ((pgm_read_byte(&ALIVE_WINDOWS[i].days) & day) &&
+        (time >= pgm_read_word(&ALIVE_WINDOWS[i].from)) &&
+        (time < pgm_read_word(&ALIVE_WINDOWS[i].to)))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Next minute of the week after the given one at which a window starts
+ * while the clock is asleep. The same minute a week later if there is none.
+ */
+inline uint16_t nextAliveMinute(uint16_t minute)
+{
+  uint16_t best = MINUTES_PER_WEEK; // distance
+  for (uint8_t day = 0; day < 7; day++)
+  {
+    for (uint8_t i = 0; i < ALIVE_WINDOW_COUNT; i++)
+    {
+      if (!(pgm_read_byte(&ALIVE_WINDOWS[i].days) & (1 << day)))
+        continue;
+
+      uint16_t start = (day * MINUTES_PER_DAY) + pgm_read_word(&ALIVE_WINDOWS[i].from);
+      uint16_t distance = (start + MINUTES_PER_WEEK - minute) % MINUTES_PER_WEEK;
+      if ((distance > 0) && (distance < best) && !isAliveAt((start + MINUTES_PER_WEEK - 1) % MINUTES_PER_WEEK))
+        best = distance; // clock was asleep right before, so it wakes up here
+    }
+  }
+  return (minute + best) % MINUTES_PER_WEEK;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef WORDCLOCK_SCHEDULER_HEADER
+#define WORDCLOCK_SCHEDULER_HEADER
+
+/*
+  Cooperative scheduler with a fixed amount of task slots.
+
+  Each task runs when its deadline (micros()) is due, then the deadline
+  moves on by the task's interval. A task which fell behind by more than
+  one interval skips the missed runs instead of catching up in a burst.
+  Tasks must not block, they are called one after another from loop().
+*/
+
+typedef void (*TaskCallback)();
+
+struct task
+{
+  /**
+   * Function to run, no task when NULL.
+   */
+  TaskCallback callback;
+
+  /**
+   * Time between two runs in microseconds.
+   */
+  uint32_t interval;
+
+  /**
+   * micros() timestamp of the next run.
+   */
+  uint32_t due;
+};
+typedef struct task Task;
+
+class Scheduler
+{
+public:
+  Scheduler() : tasks(){};
+  ~Scheduler(){};
+
+  /**
+   * Assign a task to a slot, it will run immediately.
+   */
+  void setTask(uint8_t slot, TaskCallback callback, uint32_t interval)
+  {
+    tasks[slot].callback = callback;
+    tasks[slot].interval = interval;
+    tasks[slot].due = micros();
+  }
+
+  /**
+   * Change the interval of a task, applied from its next run on.
+   */
+  void setInterval(uint8_t slot, uint32_t interval)
+  {
+    tasks[slot].due += interval - tasks[slot].interval;
+    tasks[slot].interval = interval;
+  }
+
+  /**
+   * Run all tasks which are due, in order of their slots.
+   * Returns false when no task was due.
+   */
+  bool run()
+  {
+    bool hasRun = false;
+    for (uint8_t i = 0; i < SCHEDULER_TASKS; i++)
+    {
+      Task &task = tasks[i];
+      if (task.callback == NULL)
+        continue;
+
+      uint32_t now = micros();
+      if ((int32_t)(now - task.due) < 0)
+        continue;
+
+      task.due += task.interval;
+      if ((int32_t)(now - task.due) >= 0)
+        task.due = now + task.interval; // fell behind, skip missed runs
+
+      task.callback();
+      hasRun = true;
+    }
+    return hasRun;
+  }
+
+private:
+  Task tasks[SCHEDULER_TASKS];
+};
+
+#endif
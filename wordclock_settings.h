@@ -0,0 +1,146 @@
+#ifndef WORDCLOCK_SETTINGS_HEADER
+#define WORDCLOCK_SETTINGS_HEADER
+
+#if !BOARD_ESP32
+#include <avr/eeprom.h>
+#endif
+
+/*
+  Settings kept in EEPROM.
+
+  Records are written round robin into SETTINGS_SLOTS slots, each write
+  goes to the slot after the newest one, so the cells wear evenly. The
+  newest valid record is the one with the highest sequence number, a
+  record torn by a reset fails its checksum and the one before is used.
+
+  Saving is coalesced: touch() marks a change, the record is only
+  written once there were no more changes for SETTINGS_DELAY ms. Writing
+  never blocks, run() writes one byte whenever the EEPROM is ready
+  (about 3.3 ms per byte). On ESP32 the bytes go to the RAM cache of
+  the emulated EEPROM, which is committed to flash once per record.
+*/
+
+#define SETTINGS_VERSION 1
+#define SETTINGS_FLAG_SCHEDULE (1 << 0)
+#define SETTINGS_FLAG_AUTO_HUE (1 << 1)
+#define SETTINGS_FLAG_AUTO_BRIGHTNESS (1 << 2)
+
+struct settingsRecord
+{
+  uint8_t version;
+  uint8_t sequence; // increases with every write
+  uint8_t ledMode;  // the frame rate follows from LED_MODES
+  uint8_t hue;
+  uint8_t brightness;
+  uint8_t flags;    // SETTINGS_FLAG_*
+  uint8_t checksum; // written last
+};
+typedef struct settingsRecord SettingsRecord;
+
+static_assert((SETTINGS_SLOTS * sizeof(SettingsRecord)) <= 64, "settings ring is read with a single block read into RAM");
+
+class SettingsStore
+{
+public:
+  SettingsStore() : pending(), slot(SETTINGS_SLOTS - 1), written(sizeof(SettingsRecord)), isChanged(false), changedAt(0){};
+
+  /**
+   * Find the newest valid record, with a single read of the whole ring.
+   * Returns false if there is none, e.g. on first boot.
+   */
+  bool load(SettingsRecord &record)
+  {
+    SettingsRecord ring[SETTINGS_SLOTS];
+    eeprom_read_block(ring, (const void *)SETTINGS_ADDRESS, sizeof(ring));
+
+    bool isFound = false;
+    for (uint8_t i = 0; i < SETTINGS_SLOTS; i++)
+    {
+      if ((ring[i].version != SETTINGS_VERSION) || (ring[i].checksum != checksumOf(ring[i])))
+        continue;
+      if (isFound && ((int8_t)(ring[i].sequence - record.sequence) <= 0))
+        continue;
+
+      record = ring[i];
+      slot = i;
+      isFound = true;
+    }
+    if (isFound)
+      pending = record;
+    return isFound;
+  }
+
+  /**
+   * Settings changed, save them once they are stable.
+   */
+  void touch()
+  {
+    isChanged = true;
+    changedAt = millis();
+  }
+
+  bool isDue()
+  {
+    return isChanged && !isWriting() && (millis() - changedAt >= SETTINGS_DELAY);
+  }
+
+  /**
+   * Start writing a record into the next slot, unless it equals the last one.
+   */
+  void save(const SettingsRecord &record)
+  {
+    isChanged = false;
+    if ((pending.version == SETTINGS_VERSION) &&
+        (memcmp(&record.ledMode, &pending.ledMode, sizeof(SettingsRecord) - 3) == 0))
+      return; // ledMode up to flags are unchanged
+
+    uint8_t sequence = pending.sequence + 1;
+    pending = record;
+    pending.version = SETTINGS_VERSION;
+    pending.sequence = sequence;
+    pending.checksum = checksumOf(pending);
+
+    slot = (slot + 1) % SETTINGS_SLOTS;
+    written = 0;
+  }
+
+  bool isWriting()
+  {
+    return (written < sizeof(SettingsRecord));
+  }
+
+  /**
+   * Continue writing, one byte per call at most.
+   */
+  void run()
+  {
+    if (!isWriting() || !eeprom_is_ready())
+      return;
+
+    uint8_t *address = (uint8_t *)(SETTINGS_ADDRESS + (slot * sizeof(SettingsRecord)) + written);
+    eeprom_update_byte(address, ((const uint8_t *)&pending)[written]);
+    written++;
+#if BOARD_ESP32
+    if (!isWriting())
+      EEPROM.commit();
+#endif
+  }
+
+private:
+  static uint8_t checksumOf(const SettingsRecord &record)
+  {
+    const uint8_t *bytes = (const uint8_t *)&record;
+    uint8_t sum = 0xA5; // erased cells (0xFF) do not add up
+    for (uint8_t i = 0; i < sizeof(SettingsRecord) - 1; i++)
+      sum += bytes[i];
+    return sum;
+  }
+
+  SettingsRecord pending;
+  uint8_t slot;    // newest or currently written slot
+  uint8_t written; // bytes of pending already written
+  bool isChanged;
+  uint32_t changedAt; // ms
+};
+
+#endif
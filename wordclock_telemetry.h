@@ -0,0 +1,93 @@
+#ifndef WORDCLOCK_TELEMETRY_HEADER
+#define WORDCLOCK_TELEMETRY_HEADER
+
+/*
+  Binary status frames over Serial.
+
+  Counters are plain increments at the places they count, a frame is
+  only assembled by the telemetry task. Frame layout, multi-byte values
+  little endian:
+
+     0  0xA5 0x5A            sync
+     2  version              TELEMETRY_VERSION
+     3  length               payload bytes
+     4  payload              see handleTelemetry
+     n  checksum             XOR of version, length and payload
+
+  A frame is only written when it fits into the free TX buffer, so
+  sending never blocks. Otherwise it is retried on the next run.
+*/
+
+#define TELEMETRY_SYNC_1 0xA5
+#define TELEMETRY_SYNC_2 0x5A
+#define TELEMETRY_VERSION 4
+#define TELEMETRY_FRAME_MAX 40 // has to fit into the 64 byte TX buffer
+#define TELEMETRY_REQUEST 't'  // request a frame right away over Serial
+
+struct telemetryCounters
+{
+  uint16_t irReceived; // NEC values taken from the queue, repeats included
+  uint16_t irUnknown;  // UNKNOWN signals, i.e. noise
+  uint16_t rtcReads;
+  uint16_t rtcErrors;
+  uint16_t frames;                // rendered since the last status frame
+  uint16_t sleeps;                // power downs by the schedule
+  volatile uint16_t wakeUps;      // alarms, counted in isrAlarm
+  volatile uint16_t resumeMicros; // wake-up to the first shown frame, last wake-up only, saturates
+  uint16_t bootMillis;            // reset to the first shown frame, without the bootloader
+  uint32_t idles;                 // idle sleeps since the last status frame
+  uint32_t idleMicros;            // time spent in them
+};
+typedef struct telemetryCounters TelemetryCounters;
+
+class TelemetryFrame
+{
+public:
+  TelemetryFrame() : data(), length(4){};
+
+  void put8(uint8_t value)
+  {
+    data[length++] = value;
+  }
+
+  void put16(uint16_t value)
+  {
+    put8(value & 0xFF);
+    put8(value >> 8);
+  }
+
+  void put32(uint32_t value)
+  {
+    put16(value & 0xFFFF);
+    put16(value >> 16);
+  }
+
+  /**
+   * Write the header and checksum.
+   * Returns false without writing when the TX buffer has not enough room.
+   */
+  bool send(HardwareSerial &out)
+  {
+    if (out.availableForWrite() < length + 1)
+      return false;
+
+    data[0] = TELEMETRY_SYNC_1;
+    data[1] = TELEMETRY_SYNC_2;
+    data[2] = TELEMETRY_VERSION;
+    data[3] = length - 4;
+
+    uint8_t checksum = 0;
+    for (uint8_t i = 2; i < length; i++)
+      checksum ^= data[i];
+    data[length] = checksum;
+
+    out.write(data, length + 1);
+    return true;
+  }
+
+private:
+  uint8_t data[TELEMETRY_FRAME_MAX];
+  uint8_t length;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef WORDCLOCK_TIMER_HEADER
+#define WORDCLOCK_TIMER_HEADER
+
+/*
+  Tick service based on Timer1 in CTC mode.
+
+  Prescaler and compare value for TIMER_TICK_MS are computed at compile
+  time, the smallest prescaler whose compare value fits into the 16-bit
+  OCR1A is used. timerTicks counts ticks since boot.
+
+  The ESP32 has no Timer1, ticks are derived from millis() there.
+*/
+
+#define MS_TO_TICKS(ms) ((ms) / TIMER_TICK_MS)
+
+#if BOARD_ESP32
+/**
+ * Ticks since boot.
+ */
+inline uint32_t getTicks()
+{
+  return millis() / TIMER_TICK_MS;
+}
+#else
+
+/**
+ * Timer counts per tick for the given prescaler.
+ */
+constexpr uint32_t timerCounts(uint32_t prescale)
+{
+  return (BOARD_FREQ / 1000UL) * TIMER_TICK_MS / prescale;
+}
+
+/**
+ * Smallest prescaler which fits a tick into 16 bit.
+ */
+constexpr uint16_t timerPrescale()
+{
+  return (timerCounts(1) <= 65536UL)      ? 1
+         : (timerCounts(8) <= 65536UL)    ? 8
+         : (timerCounts(64) <= 65536UL)   ? 64
+         : (timerCounts(256) <= 65536UL)  ? 256
+                                          : 1024;
+}
+
+/**
+ * Clock select bits of TCCR1B for the given prescaler.
+ */
+constexpr uint8_t timerClockSelect(uint16_t prescale)
+{
+  return (prescale == 1)     ? (1 << CS10)
+         : (prescale == 8)   ? (1 << CS11)
+         : (prescale == 64)  ? ((1 << CS11) | (1 << CS10))
+         : (prescale == 256) ? (1 << CS12)
+                             : ((1 << CS12) | (1 << CS10));
+}
+
+constexpr uint16_t TIMER_PRESCALE = timerPrescale();
+constexpr uint32_t TIMER_COUNTS = timerCounts(TIMER_PRESCALE);
+
+static_assert(TIMER_TICK_MS > 0, "TIMER_TICK_MS has to be at least 1 ms");
+static_assert(TIMER_COUNTS <= 65536UL, "TIMER_TICK_MS too long for Timer1, even at prescaler 1024");
+static_assert(((BOARD_FREQ / 1000UL) * TIMER_TICK_MS) % TIMER_PRESCALE == 0, "TIMER_TICK_MS is no whole number of timer counts");
+
+volatile uint32_t timerTicks = 0;
+
+/**
+ * Ticks since boot, read atomically.
+ */
+inline uint32_t getTicks()
+{
+  noInterrupts();
+  uint32_t ticks = timerTicks;
+  interrupts();
+  return ticks;
+}
+#endif
+
+#endif